@@ -0,0 +1,67 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// broadphase_benchmark.cpp
+// pair counts and timings of every broadphase backend on the same recorded
+// scenes (see tests/broadphasescenes.h), single-threaded
+// -----------------------------------------------------------------------------
+#include "broadphasescenes.h"
+#include "broadphase.h"
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+static constexpr BroadphaseType BACKENDS[] = {
+    BroadphaseType::BruteForce,
+    BroadphaseType::SpatialHash,
+    BroadphaseType::DynamicTree,
+    BroadphaseType::SweepAndPrune
+};
+
+int main() {
+    // no workers: the pair search runs on this thread only
+    ThreadPool threadPool(0);
+
+    for (const auto& scene : RECORDED_SCENES) {
+        const std::vector<SceneFrame> recording = RecordScene(scene);
+        std::printf("scene: %s (%zu colliders on the last frame, %zu frames)\n", scene.name, recording.back().ids.size(), recording.size());
+
+        for (const bool withLayers : {false, true}) {
+            const CollisionLayerMatrix layers = withLayers ? GameLayerMatrix() : CollisionLayerMatrix();
+            std::printf("  %s\n", withLayers ? "game layer matrix" : "every layer collides");
+            std::printf("  %-16s %16s %16s %16s\n", "backend", "candidates/frame", "overlaps/frame", "us/frame");
+
+            for (const auto type : BACKENDS) {
+                BroadphaseSettings settings;
+                settings.type = type;
+                const std::unique_ptr<IBroadphase> broadphase = CreateBroadphase(settings);
+
+                std::vector<ColliderPair> candidates;
+                size_t candidateCount = 0;
+                size_t overlapCount = 0;
+                std::chrono::nanoseconds time{0};
+                for (const auto& frame : recording) {
+                    const std::vector<CollisionFilter> filters = GetFilters(frame, layers);
+                    const auto start = std::chrono::steady_clock::now();
+                    broadphase->FindPairs(frame.ids, frame.bounds, filters, candidates, threadPool);
+                    time += std::chrono::steady_clock::now() - start;
+
+                    candidateCount += candidates.size();
+                    overlapCount += OverlappingPairs(frame.bounds, candidates).size();
+                }
+
+                const double frames = static_cast<double>(recording.size());
+                std::printf("  %-16s %16.1f %16.1f %16.1f\n", broadphase->GetName(), candidateCount / frames, overlapCount / frames,
+                    std::chrono::duration<double, std::micro>(time).count() / frames);
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// broadphase_scaling_benchmark.cpp
+// how the pair search of every broadphase backend scales with the thread pool:
+// the biggest recorded scenes replayed with 1 thread (no workers) up to one
+// thread per core, pass the highest thread count to go further
+// -----------------------------------------------------------------------------
+#include "broadphasescenes.h"
+#include "broadphase.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+static constexpr BroadphaseType BACKENDS[] = {
+    BroadphaseType::SpatialHash,
+    BroadphaseType::DynamicTree,
+    BroadphaseType::SweepAndPrune,
+    BroadphaseType::BruteForce
+};
+
+// each scene is replayed this many times per thread count, the best run is kept
+static constexpr int RUNS = 3;
+
+static double MicrosecondsPerFrame(BroadphaseType type, const std::vector<SceneFrame>& recording,
+    const std::vector<std::vector<CollisionFilter>>& filters, ThreadPool& threadPool) {
+    double best = 0.0;
+    for (int run = 0; run < RUNS; run++) {
+        BroadphaseSettings settings;
+        settings.type = type;
+        const std::unique_ptr<IBroadphase> broadphase = CreateBroadphase(settings);
+        std::vector<ColliderPair> pairs;
+
+        const auto start = std::chrono::steady_clock::now();
+        for (size_t frame = 0; frame < recording.size(); frame++) {
+            broadphase->FindPairs(recording[frame].ids, recording[frame].bounds, filters[frame], pairs, threadPool);
+        }
+        const double time = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / recording.size();
+        best = run == 0 || time < best ? time : best;
+    }
+    return best;
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned int cores = std::max(1u, std::thread::hardware_concurrency());
+    const unsigned int maxThreads = argc > 1 ? std::max(1, std::atoi(argv[1])) : cores;
+
+    // 1, 2, 4, ... threads, and the highest count itself
+    std::vector<unsigned int> threadCounts;
+    for (unsigned int threads = 1; threads < maxThreads; threads *= 2) {
+        threadCounts.push_back(threads);
+    }
+    threadCounts.push_back(maxThreads);
+
+    std::printf("%u hardware threads, us/frame (speedup over 1 thread)\n", cores);
+    const CollisionLayerMatrix layers = GameLayerMatrix();
+    for (const auto& scene : {RECORDED_SCENES[2], RECORDED_SCENES[3]}) {
+        const std::vector<SceneFrame> recording = RecordScene(scene);
+        std::vector<std::vector<CollisionFilter>> filters;
+        for (const auto& frame : recording) {
+            filters.push_back(GetFilters(frame, layers));
+        }
+
+        std::printf("scene: %s (%zu colliders on the last frame)\n", scene.name, recording.back().ids.size());
+        std::printf("  %-16s", "threads");
+        for (const auto threads : threadCounts) {
+            std::printf(" %17u", threads);
+        }
+        std::printf("\n");
+
+        for (const auto type : BACKENDS) {
+            double serial = 0.0;
+            std::printf("  %-16s", CreateBroadphase({type})->GetName());
+            for (const auto threads : threadCounts) {
+                // the calling thread takes part in ParallelFor, so it's one worker less
+                ThreadPool threadPool(threads - 1);
+                const double time = MicrosecondsPerFrame(type, recording, filters, threadPool);
+                serial = threads == 1 ? time : serial;
+                std::printf(" %9.1f (%4.2fx)", time, serial / time);
+            }
+            std::printf("\n");
+        }
+    }
+    return 0;
+}
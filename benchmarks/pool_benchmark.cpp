@@ -0,0 +1,197 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// pool_benchmark.cpp
+// benchmark of the sparse set Pool<T> against the unordered_map indexed pool
+// it replaced, at 10k/100k/1M entities (make bench)
+// -----------------------------------------------------------------------------
+#include "ecs.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// MAP POOL
+// the previous Pool<T>: a packed vector indexed through two hash maps
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+template <typename T>
+class MapPool {
+public:
+    MapPool(int capacity = 100) {
+        size = 0;
+        data.resize(capacity);
+    }
+
+    int GetSize() const {return size;}
+
+    void Set(int entityId, T object) {
+        if (entityIdToIndex.find(entityId) != entityIdToIndex.end()) {
+            int index = entityIdToIndex[entityId];
+            data[index] = object;
+        }
+        else {
+            int index = size;
+            entityIdToIndex.emplace(entityId, index);
+            indexToEntityId.emplace(index, entityId);
+            if (index >= static_cast<int>(data.capacity())) {
+                data.resize(size * 2);
+            }
+            data[index] = object;
+            size++;
+        }
+    }
+
+    void Remove(int entityId) {
+        int indexOfRemoved = entityIdToIndex[entityId];
+        int indexOfLast = size - 1;
+        data[indexOfRemoved] = data[indexOfLast];
+
+        int entityIdOfLastElement = indexToEntityId[indexOfLast];
+        entityIdToIndex[entityIdOfLastElement] = indexOfRemoved;
+        indexToEntityId[indexOfRemoved] = entityIdOfLastElement;
+
+        entityIdToIndex.erase(entityId);
+        indexToEntityId.erase(indexOfLast);
+
+        size--;
+    }
+
+    T& Get(int entityId) {
+        int index = entityIdToIndex[entityId];
+        return data[index];
+    }
+
+    T& operator [](unsigned int index) {return data[index];}
+
+private:
+    std::vector<T> data;
+    int size;
+    std::unordered_map<int, int> entityIdToIndex;
+    std::unordered_map<int, int> indexToEntityId;
+};
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// BENCHMARK
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// a transform-sized component
+struct BenchComponent {
+    float x = 0.0f;
+    float y = 0.0f;
+    float velocityX = 0.0f;
+    float velocityY = 0.0f;
+};
+
+struct Timings {
+    double set = 0.0;
+    double getSequential = 0.0;
+    double getRandom = 0.0;
+    double iterate = 0.0;
+    double remove = 0.0;
+};
+
+// keeps the compiler from dropping the reads
+static volatile float sink = 0.0f;
+
+template <typename TFunc>
+static double NanosecondsPerOp(int ops, TFunc&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+// the same workload on either pool: set n components, read them in id and in random order,
+// walk the packed array, then remove half of them in random order
+template <typename TPool>
+static Timings Run(TPool& pool, int n, const std::vector<int>& shuffledIds) {
+    Timings timings;
+    timings.set = NanosecondsPerOp(n, [&] {
+        for (int id = 0; id < n; id++) {
+            pool.Set(id, BenchComponent{static_cast<float>(id), 0.0f, 1.0f, 1.0f});
+        }
+    });
+    timings.getSequential = NanosecondsPerOp(n, [&] {
+        float sum = 0.0f;
+        for (int id = 0; id < n; id++) {
+            sum += pool.Get(id).x;
+        }
+        sink = sum;
+    });
+    timings.getRandom = NanosecondsPerOp(n, [&] {
+        float sum = 0.0f;
+        for (const int id : shuffledIds) {
+            sum += pool.Get(id).x;
+        }
+        sink = sum;
+    });
+    timings.iterate = NanosecondsPerOp(n, [&] {
+        for (int i = 0; i < pool.GetSize(); i++) {
+            BenchComponent& component = pool[i];
+            component.x += component.velocityX;
+            component.y += component.velocityY;
+        }
+        sink = pool[0].x;
+    });
+    timings.remove = NanosecondsPerOp(n / 2, [&] {
+        for (int i = 0; i < n / 2; i++) {
+            pool.Remove(shuffledIds[i]);
+        }
+    });
+    return timings;
+}
+
+// best of a few runs on fresh pools, the first run of a size mostly measures page faults
+template <typename TPool>
+static Timings Best(int n, const std::vector<int>& shuffledIds) {
+    Timings best;
+    for (int repetition = 0; repetition < 3; repetition++) {
+        TPool pool;
+        const Timings timings = Run(pool, n, shuffledIds);
+        if (repetition == 0) {
+            best = timings;
+            continue;
+        }
+        best.set = std::min(best.set, timings.set);
+        best.getSequential = std::min(best.getSequential, timings.getSequential);
+        best.getRandom = std::min(best.getRandom, timings.getRandom);
+        best.iterate = std::min(best.iterate, timings.iterate);
+        best.remove = std::min(best.remove, timings.remove);
+    }
+    return best;
+}
+
+static void Print(const char* name, int n, const Timings& timings) {
+    std::printf("%-12s %9d %10.1f %10.1f %10.1f %10.1f %10.1f\n", name, n,
+        timings.set, timings.getSequential, timings.getRandom, timings.iterate, timings.remove);
+}
+
+int main() {
+    std::printf("ns per operation (best of 3)\n");
+    std::printf("%-12s %9s %10s %10s %10s %10s %10s\n", "pool", "entities", "set", "get seq", "get rand", "iterate", "remove");
+
+    for (const int n : {10000, 100000, 1000000}) {
+        std::vector<int> shuffledIds(n);
+        std::iota(shuffledIds.begin(), shuffledIds.end(), 0);
+        std::shuffle(shuffledIds.begin(), shuffledIds.end(), std::mt19937(n));
+
+        Print("map", n, Best<MapPool<BenchComponent>>(n, shuffledIds));
+        Print("sparse set", n, Best<Pool<BenchComponent>>(n, shuffledIds));
+    }
+    return 0;
+}
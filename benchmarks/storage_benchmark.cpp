@@ -0,0 +1,120 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// storage_benchmark.cpp
+// benchmark of the registry component storage, built once per backend (pool
+// and archetype, make bench) so both run the same scene through the registry
+// -----------------------------------------------------------------------------
+#include "ecs.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#ifdef ECS_ARCHETYPE_STORAGE
+static const char* BACKEND = "archetype";
+#else
+static const char* BACKEND = "pool";
+#endif
+
+static constexpr int FRAMES = 50;
+
+// keeps the compiler from dropping the reads
+static volatile float sink = 0.0f;
+
+template <typename TFunc>
+static double NanosecondsPerOp(size_t ops, TFunc&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ops;
+}
+
+// a scene like a level in play: half the entities move (transform, rigid body, sprite),
+// the other half is the tilemap (transform, sprite)
+static void Run(int n) {
+    Registry registry;
+    std::vector<Entity> movers;
+    std::vector<Entity> entities;
+    movers.reserve(n / 2);
+    entities.reserve(n);
+
+    const double create = NanosecondsPerOp(n, [&] {
+        for (int i = 0; i < n; i++) {
+            Entity entity = registry.CreateEntity();
+            entity.AddComponent<TransformComponent>(glm::vec2(i % 1000, i / 1000));
+            if (i % 2 == 0) {
+                entity.AddComponent<RigidBodyComponent>(glm::vec2(1.0f, 0.5f));
+                movers.push_back(entity);
+            }
+            entity.AddComponent<SpriteComponent>("tile", 32, 32);
+            entities.push_back(entity);
+        }
+        registry.Update();
+    });
+
+    // the movement system: every entity with a transform and a rigid body
+    const double move = NanosecondsPerOp(static_cast<size_t>(FRAMES) * movers.size(), [&] {
+        for (int frame = 0; frame < FRAMES; frame++) {
+            registry.View<TransformComponent, RigidBodyComponent>().Each([](Entity, TransformComponent& transform, RigidBodyComponent& rigidBody) {
+                transform.position += rigidBody.velocity * 0.016f;
+            });
+        }
+    });
+
+    // the render system: reads the transform and sprite of every entity
+    const double render = NanosecondsPerOp(static_cast<size_t>(FRAMES) * entities.size(), [&] {
+        float sum = 0.0f;
+        for (int frame = 0; frame < FRAMES; frame++) {
+            registry.View<TransformComponent, SpriteComponent>().Each([&sum](Entity, TransformComponent& transform, SpriteComponent& sprite) {
+                sum += transform.position.x + sprite.width;
+            });
+        }
+        sink = sum;
+    });
+
+    // systems that look components up through their entity lists, in no particular order
+    std::vector<Entity> shuffled = entities;
+    std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937(n));
+    const double lookup = NanosecondsPerOp(shuffled.size(), [&] {
+        float sum = 0.0f;
+        for (const auto& entity : shuffled) {
+            sum += entity.GetComponent<TransformComponent>().position.y;
+        }
+        sink = sum;
+    });
+
+    // a tenth of the movers stop and start again, moving between archetypes twice
+    const size_t churned = movers.size() / 10;
+    const double churn = NanosecondsPerOp(2 * churned, [&] {
+        for (size_t i = 0; i < churned; i++) {
+            movers[i].RemoveComponent<RigidBodyComponent>();
+        }
+        for (size_t i = 0; i < churned; i++) {
+            movers[i].AddComponent<RigidBodyComponent>(glm::vec2(1.0f, 0.5f));
+        }
+        registry.Update();
+    });
+
+    std::printf("%-10s %9d %10.1f %10.1f %10.1f %10.1f %10.1f\n", BACKEND, n, create, move, render, lookup, churn);
+}
+
+int main() {
+    // the registry logs its construction and destruction, keep the table readable
+    spdlog::set_level(spdlog::level::warn);
+
+    std::printf("ns per entity (create: 2-3 AddComponent each, move/render: per entity per frame, churn: per add/remove)\n");
+    std::printf("%-10s %9s %10s %10s %10s %10s %10s\n", "backend", "entities", "create", "move", "render", "lookup", "churn");
+    for (const int n : {10000, 100000}) {
+        Run(n);
+    }
+    return 0;
+}
@@ -12,16 +12,16 @@
 // implementation file for AssetStore class
 // -----------------------------------------------------------------------------
 #include "headers/assetstore.h"
-#include <spdlog/spdlog.h>
+#include "headers/logger.h"
 #include <SDL2/SDL_image.h>
 
 AssetStore::AssetStore() {
-    spdlog::info("AssetStore constructor called!");
+    LOG_INFO(LogCategory::Assets, "AssetStore constructor called!");
 }
 
 AssetStore::~AssetStore() {
     ClearAssets();
-    spdlog::info("AssetStore destructor called!");
+    LOG_INFO(LogCategory::Assets, "AssetStore destructor called!");
 }
 
 void AssetStore::ClearAssets() {
@@ -29,6 +29,8 @@ void AssetStore::ClearAssets() {
         SDL_DestroyTexture(texture.second);
     }
     textures.clear();
+    textureHandles.clear();
+    texturesByHandle.clear();
 
     for (auto font : fonts) {
         TTF_CloseFont(font.second);
@@ -42,15 +44,27 @@ void AssetStore::AddTexture(SDL_Renderer* renderer, const std::string& assetId,
     SDL_FreeSurface(surface);
 
     // add the texture to the map
-    textures.emplace(assetId, texture);
+    if (textures.emplace(assetId, texture).second) {
+        textureHandles.emplace(assetId, static_cast<int>(texturesByHandle.size()));
+        texturesByHandle.push_back(texture);
+    }
 
-    spdlog::info("New texture added to the Asset Store with id = " + assetId);
+    LOG_INFO(LogCategory::Assets, "New texture added to the Asset Store with id = {}", assetId);
 }
 
 SDL_Texture* AssetStore::GetTexture(const std::string& assetId) {
     return textures[assetId];
 }
 
+int AssetStore::GetTextureHandle(const std::string& assetId) const {
+    const auto handle = textureHandles.find(assetId);
+    return handle != textureHandles.end() ? handle->second : -1;
+}
+
+SDL_Texture* AssetStore::GetTexture(int textureHandle) const {
+    return textureHandle >= 0 && textureHandle < static_cast<int>(texturesByHandle.size()) ? texturesByHandle[textureHandle] : nullptr;
+}
+
 void AssetStore::AddFont(const std::string& assetId, const std::string& filePath, int fontSize) {
     fonts.emplace(assetId, TTF_OpenFont(filePath.c_str(), fontSize));
 }
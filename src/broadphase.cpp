@@ -0,0 +1,296 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// broadphase.cpp
+// implementation file for the collision broadphase backends
+// -----------------------------------------------------------------------------
+#include "headers/broadphase.h"
+#include "headers/spatialhash.h"
+#include <algorithm>
+
+std::unique_ptr<IBroadphase> CreateBroadphase(const BroadphaseSettings& settings) {
+    switch (settings.type) {
+        case BroadphaseType::BruteForce:
+            return std::make_unique<BruteForceBroadphase>();
+        case BroadphaseType::DynamicTree:
+            return std::make_unique<TreeBroadphase>(settings.treeMargin);
+        case BroadphaseType::SweepAndPrune:
+            return std::make_unique<SweepAndPruneBroadphase>();
+        case BroadphaseType::SpatialHash:
+        default:
+            return std::make_unique<SpatialHash>(settings.cellSize);
+    }
+}
+
+// number of chunks ParallelFor() splits count items in
+static size_t ChunkCount(size_t count, size_t grainSize) {
+    return (count + grainSize - 1) / grainSize;
+}
+
+// grows a per id array so id is a valid index
+template <typename T>
+static void FitId(std::vector<T>& values, int id, T fill) {
+    if (id >= static_cast<int>(values.size())) {
+        values.resize(id + 1, fill);
+    }
+}
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// PAIR BUFFERS
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+void PairBuffers::Reset(size_t chunkCount) {
+    if (chunks.size() < chunkCount) {
+        chunks.resize(chunkCount);
+    }
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        chunks[chunk].clear();
+    }
+    this->chunkCount = chunkCount;
+}
+
+void PairBuffers::Merge(std::vector<ColliderPair>& pairs, ThreadPool& threadPool) {
+    pairs.clear();
+    if (chunkCount == 0) {
+        return;
+    }
+
+    // a single chunk already is the sorted list (e.g. a pool without workers)
+    if (chunkCount == 1) {
+        pairs.swap(chunks[0]);
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+        return;
+    }
+
+    // copy the chunks one after the other...
+    chunkStarts.resize(chunkCount + 1);
+    chunkStarts[0] = 0;
+    for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+        chunkStarts[chunk + 1] = chunkStarts[chunk] + chunks[chunk].size();
+    }
+    pairs.resize(chunkStarts[chunkCount]);
+    threadPool.ParallelFor(0, chunkCount, 1, [&](size_t chunkBegin, size_t chunkEnd) {
+        for (size_t chunk = chunkBegin; chunk < chunkEnd; chunk++) {
+            std::copy(chunks[chunk].begin(), chunks[chunk].end(), pairs.begin() + chunkStarts[chunk]);
+        }
+    });
+
+    // ...then merge neighbouring sorted runs, doubling their length each round (the merges of a round run in parallel)
+    mergeBuffer.resize(pairs.size());
+    std::vector<ColliderPair>* source = &pairs;
+    std::vector<ColliderPair>* target = &mergeBuffer;
+    for (size_t width = 1; width < chunkCount; width *= 2) {
+        threadPool.ParallelFor(0, ChunkCount(chunkCount, 2 * width), 1, [&](size_t groupBegin, size_t groupEnd) {
+            for (size_t group = groupBegin; group < groupEnd; group++) {
+                const size_t first = group * 2 * width;
+                const size_t middle = std::min(first + width, chunkCount);
+                const size_t last = std::min(first + 2 * width, chunkCount);
+                std::merge(source->begin() + chunkStarts[first], source->begin() + chunkStarts[middle],
+                           source->begin() + chunkStarts[middle], source->begin() + chunkStarts[last],
+                           target->begin() + chunkStarts[first]);
+            }
+        });
+        std::swap(source, target);
+    }
+    if (source != &pairs) {
+        pairs.swap(mergeBuffer);
+    }
+
+    pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+}
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// BRUTE FORCE BROADPHASE
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+void BruteForceBroadphase::FindPairs(std::span<const int>, std::span<const AABB> bounds, std::span<const CollisionFilter> filters, std::vector<ColliderPair>& pairs, ThreadPool& threadPool) {
+    colliderBounds.assign(bounds.begin(), bounds.end());
+
+    // a chunk of rows a: its pairs come out sorted
+    pairBuffers.Reset(ChunkCount(bounds.size(), BROADPHASE_COLLIDERS_PER_CHUNK));
+    const int count = static_cast<int>(bounds.size());
+    threadPool.ParallelFor(0, bounds.size(), BROADPHASE_COLLIDERS_PER_CHUNK, [&](size_t chunkBegin, size_t chunkEnd) {
+        auto& chunkPairs = pairBuffers.GetChunk(chunkBegin / BROADPHASE_COLLIDERS_PER_CHUNK);
+        for (int a = static_cast<int>(chunkBegin); a < static_cast<int>(chunkEnd); a++) {
+            for (int b = a + 1; b < count; b++) {
+                if (filters[a].CanCollide(filters[b]) && bounds[a].Overlaps(bounds[b])) {
+                    chunkPairs.push_back({a, b});
+                }
+            }
+        }
+    });
+    pairBuffers.Merge(pairs, threadPool);
+}
+
+void BruteForceBroadphase::QueryArea(const AABB& area, ColliderVisitor visit, void* context) const {
+    for (int index = 0; index < static_cast<int>(colliderBounds.size()); index++) {
+        if (colliderBounds[index].Overlaps(area)) {
+            visit(context, index);
+        }
+    }
+}
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// TREE BROADPHASE
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+void TreeBroadphase::FindPairs(std::span<const int> ids, std::span<const AABB> bounds, std::span<const CollisionFilter> filters, std::vector<ColliderPair>& pairs, ThreadPool& threadPool) {
+    pairs.clear();
+    frame++;
+
+    // move the leaves of the known colliders, add the new ones
+    for (int index = 0; index < static_cast<int>(ids.size()); index++) {
+        const int id = ids[index];
+        FitId(proxyOfId, id, static_cast<int>(DynamicAABBTree::NULL_NODE));
+        FitId(frameSeen, id, 0u);
+
+        int& proxyId = proxyOfId[id];
+        if (proxyId == DynamicAABBTree::NULL_NODE) {
+            proxyId = tree.CreateProxy(bounds[index], index);
+            trackedIds.push_back(id);
+        } else {
+            tree.MoveProxy(proxyId, bounds[index]);
+            tree.SetUserData(proxyId, index);
+        }
+        frameSeen[id] = frame;
+    }
+
+    // drop the leaves of the colliders that are gone
+    std::erase_if(trackedIds, [this](int id) {
+        if (frameSeen[id] == frame) {
+            return false;
+        }
+        tree.DestroyProxy(proxyOfId[id]);
+        proxyOfId[id] = DynamicAABBTree::NULL_NODE;
+        return true;
+    });
+
+    // each collider queries the tree (chunks of colliders in parallel, the tree isn't changed), a pair is kept by its lower index
+    pairBuffers.Reset(ChunkCount(bounds.size(), BROADPHASE_COLLIDERS_PER_CHUNK));
+    threadPool.ParallelFor(0, bounds.size(), BROADPHASE_COLLIDERS_PER_CHUNK, [&](size_t chunkBegin, size_t chunkEnd) {
+        auto& chunkPairs = pairBuffers.GetChunk(chunkBegin / BROADPHASE_COLLIDERS_PER_CHUNK);
+        for (int a = static_cast<int>(chunkBegin); a < static_cast<int>(chunkEnd); a++) {
+            tree.Query(bounds[a], [this, a, filters, &chunkPairs](int proxyId) {
+                const int b = tree.GetUserData(proxyId);
+                if (b > a && filters[a].CanCollide(filters[b])) {
+                    chunkPairs.push_back({a, b});
+                }
+                return true;
+            });
+        }
+        std::sort(chunkPairs.begin(), chunkPairs.end());
+    });
+    pairBuffers.Merge(pairs, threadPool);
+}
+
+void TreeBroadphase::QueryArea(const AABB& area, ColliderVisitor visit, void* context) const {
+    tree.Query(area, [this, visit, context](int proxyId) {
+        visit(context, tree.GetUserData(proxyId));
+        return true;
+    });
+}
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// SWEEP AND PRUNE BROADPHASE
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+void SweepAndPruneBroadphase::FindPairs(std::span<const int> ids, std::span<const AABB> bounds, std::span<const CollisionFilter> filters, std::vector<ColliderPair>& pairs, ThreadPool& threadPool) {
+    pairs.clear();
+    frame++;
+
+    for (int index = 0; index < static_cast<int>(ids.size()); index++) {
+        const int id = ids[index];
+        FitId(indexOfId, id, -1);
+        FitId(frameSeen, id, 0u);
+        if (id >= static_cast<int>(isTracked.size())) {
+            isTracked.resize(id + 1, false);
+        }
+        indexOfId[id] = index;
+        frameSeen[id] = frame;
+    }
+
+    // refresh the intervals of the known colliders (in place, so the order is mostly kept) and drop the gone ones
+    std::erase_if(intervals, [this, bounds](Interval& interval) {
+        if (frameSeen[interval.id] != frame) {
+            isTracked[interval.id] = false;
+            return true;
+        }
+        interval.index = indexOfId[interval.id];
+        interval.minX = bounds[interval.index].minX;
+        interval.maxX = bounds[interval.index].maxX;
+        return false;
+    });
+
+    // new colliders join at the end, the sort moves them in place
+    for (int index = 0; index < static_cast<int>(ids.size()); index++) {
+        const int id = ids[index];
+        if (!isTracked[id]) {
+            isTracked[id] = true;
+            intervals.push_back({bounds[index].minX, bounds[index].maxX, id, index});
+        }
+    }
+
+    // insertion sort by min x, close to linear when the colliders barely moved since the last frame
+    for (size_t i = 1; i < intervals.size(); i++) {
+        const Interval interval = intervals[i];
+        size_t j = i;
+        while (j > 0 && intervals[j - 1].minX > interval.minX) {
+            intervals[j] = intervals[j - 1];
+            j--;
+        }
+        intervals[j] = interval;
+    }
+
+    maxWidth = 0.0;
+    for (const auto& interval : intervals) {
+        maxWidth = std::max(maxWidth, static_cast<double>(interval.maxX) - interval.minX);
+    }
+
+    // sweep: an interval overlaps the ones that start before it ends, y prunes the rest
+    // (chunks of sorted intervals in parallel, each one only reads the intervals after it)
+    pairBuffers.Reset(ChunkCount(intervals.size(), BROADPHASE_COLLIDERS_PER_CHUNK));
+    threadPool.ParallelFor(0, intervals.size(), BROADPHASE_COLLIDERS_PER_CHUNK, [&](size_t chunkBegin, size_t chunkEnd) {
+        auto& chunkPairs = pairBuffers.GetChunk(chunkBegin / BROADPHASE_COLLIDERS_PER_CHUNK);
+        for (size_t i = chunkBegin; i < chunkEnd; i++) {
+            const Interval& first = intervals[i];
+            const AABB& firstBounds = bounds[first.index];
+            for (size_t j = i + 1; j < intervals.size() && intervals[j].minX < first.maxX; j++) {
+                const int second = intervals[j].index;
+                const AABB& secondBounds = bounds[second];
+                if (firstBounds.minY < secondBounds.maxY && firstBounds.maxY > secondBounds.minY && filters[first.index].CanCollide(filters[second])) {
+                    chunkPairs.push_back({std::min(first.index, second), std::max(first.index, second)});
+                }
+            }
+        }
+        std::sort(chunkPairs.begin(), chunkPairs.end());
+    });
+    pairBuffers.Merge(pairs, threadPool);
+}
+
+void SweepAndPruneBroadphase::QueryArea(const AABB& area, ColliderVisitor visit, void* context) const {
+    // an interval ending after area.minX starts after area.minX - maxWidth
+    const double firstMinX = static_cast<double>(area.minX) - maxWidth;
+    auto interval = std::partition_point(intervals.begin(), intervals.end(), [firstMinX](const Interval& candidate) {
+        return candidate.minX < firstMinX;
+    });
+    for (; interval != intervals.end() && interval->minX < area.maxX; ++interval) {
+        if (interval->maxX > area.minX) {
+            visit(context, interval->index);
+        }
+    }
+}
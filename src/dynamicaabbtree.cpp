@@ -0,0 +1,214 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// dynamicaabbtree.cpp
+// implementation file for the dynamic bounding volume tree
+// -----------------------------------------------------------------------------
+#include "headers/dynamicaabbtree.h"
+#include <algorithm>
+
+int DynamicAABBTree::AllocateNode() {
+    if (freeList == NULL_NODE) {
+        nodes.push_back({});
+        freeList = static_cast<int>(nodes.size()) - 1;
+        nodes[freeList].parent = NULL_NODE;
+    }
+
+    const int nodeId = freeList;
+    Node& node = nodes[nodeId];
+    freeList = node.parent;
+    node.parent = NULL_NODE;
+    node.child1 = NULL_NODE;
+    node.child2 = NULL_NODE;
+    node.height = 0;
+    node.userData = -1;
+    return nodeId;
+}
+
+void DynamicAABBTree::FreeNode(int nodeId) {
+    nodes[nodeId].parent = freeList;
+    nodes[nodeId].height = -1;
+    freeList = nodeId;
+}
+
+void DynamicAABBTree::Clear() {
+    nodes.clear();
+    root = NULL_NODE;
+    freeList = NULL_NODE;
+}
+
+int DynamicAABBTree::CreateProxy(const AABB& bounds, int userData) {
+    const int proxyId = AllocateNode();
+    nodes[proxyId].bounds = bounds.Fattened(margin);
+    nodes[proxyId].userData = userData;
+    InsertLeaf(proxyId);
+    return proxyId;
+}
+
+void DynamicAABBTree::DestroyProxy(int proxyId) {
+    RemoveLeaf(proxyId);
+    FreeNode(proxyId);
+}
+
+bool DynamicAABBTree::MoveProxy(int proxyId, const AABB& bounds) {
+    if (nodes[proxyId].bounds.Contains(bounds)) {
+        return false;
+    }
+
+    RemoveLeaf(proxyId);
+    nodes[proxyId].bounds = bounds.Fattened(margin);
+    InsertLeaf(proxyId);
+    return true;
+}
+
+void DynamicAABBTree::InsertLeaf(int leaf) {
+    if (root == NULL_NODE) {
+        root = leaf;
+        nodes[root].parent = NULL_NODE;
+        return;
+    }
+
+    // walk down to the sibling that grows the total perimeter the least
+    const AABB leafBounds = nodes[leaf].bounds;
+    int index = root;
+    while (!nodes[index].IsLeaf()) {
+        const Node& node = nodes[index];
+        const float perimeter = node.bounds.Perimeter();
+        const float combinedPerimeter = node.bounds.Union(leafBounds).Perimeter();
+
+        // cost of making a new parent for this node and the leaf, and of pushing the leaf further down
+        const float cost = 2.0f * combinedPerimeter;
+        const float inheritanceCost = 2.0f * (combinedPerimeter - perimeter);
+
+        auto descendCost = [&](int child) {
+            const AABB& childBounds = nodes[child].bounds;
+            const float unionPerimeter = childBounds.Union(leafBounds).Perimeter();
+            return (nodes[child].IsLeaf() ? unionPerimeter : unionPerimeter - childBounds.Perimeter()) + inheritanceCost;
+        };
+        const float cost1 = descendCost(node.child1);
+        const float cost2 = descendCost(node.child2);
+
+        if (cost < cost1 && cost < cost2) {
+            break;
+        }
+        index = cost1 < cost2 ? node.child1 : node.child2;
+    }
+    const int sibling = index;
+
+    // a new parent takes the place of the sibling
+    const int oldParent = nodes[sibling].parent;
+    const int newParent = AllocateNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].bounds = leafBounds.Union(nodes[sibling].bounds);
+    nodes[newParent].height = nodes[sibling].height + 1;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+
+    if (oldParent == NULL_NODE) {
+        root = newParent;
+    } else if (nodes[oldParent].child1 == sibling) {
+        nodes[oldParent].child1 = newParent;
+    } else {
+        nodes[oldParent].child2 = newParent;
+    }
+
+    Refit(oldParent);
+}
+
+void DynamicAABBTree::RemoveLeaf(int leaf) {
+    if (leaf == root) {
+        root = NULL_NODE;
+        return;
+    }
+
+    // the sibling takes the place of the parent
+    const int parent = nodes[leaf].parent;
+    const int grandParent = nodes[parent].parent;
+    const int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+    FreeNode(parent);
+
+    nodes[sibling].parent = grandParent;
+    if (grandParent == NULL_NODE) {
+        root = sibling;
+        return;
+    }
+    if (nodes[grandParent].child1 == parent) {
+        nodes[grandParent].child1 = sibling;
+    } else {
+        nodes[grandParent].child2 = sibling;
+    }
+    Refit(grandParent);
+}
+
+void DynamicAABBTree::Refit(int nodeId) {
+    while (nodeId != NULL_NODE) {
+        nodeId = Balance(nodeId);
+        Node& node = nodes[nodeId];
+        node.height = 1 + std::max(nodes[node.child1].height, nodes[node.child2].height);
+        node.bounds = nodes[node.child1].bounds.Union(nodes[node.child2].bounds);
+        nodeId = node.parent;
+    }
+}
+
+int DynamicAABBTree::Balance(int iA) {
+    Node& a = nodes[iA];
+    if (a.IsLeaf() || a.height < 2) {
+        return iA;
+    }
+
+    const int iB = a.child1;
+    const int iC = a.child2;
+    Node& b = nodes[iB];
+    Node& c = nodes[iC];
+    const int balance = c.height - b.height;
+
+    // rotates child up to the place of a, a keeps the other child and the lower grandchild
+    auto rotateUp = [&](int iChild, Node& child, int& aChildSlot, const Node& other) {
+        const int iF = child.child1;
+        const int iG = child.child2;
+        Node& f = nodes[iF];
+        Node& g = nodes[iG];
+
+        child.child1 = iA;
+        child.parent = a.parent;
+        a.parent = iChild;
+
+        if (child.parent == NULL_NODE) {
+            root = iChild;
+        } else if (nodes[child.parent].child1 == iA) {
+            nodes[child.parent].child1 = iChild;
+        } else {
+            nodes[child.parent].child2 = iChild;
+        }
+
+        const bool keepF = f.height > g.height;
+        const int iKept = keepF ? iF : iG;
+        const int iMoved = keepF ? iG : iF;
+        child.child2 = iKept;
+        aChildSlot = iMoved;
+        nodes[iMoved].parent = iA;
+
+        a.bounds = other.bounds.Union(nodes[iMoved].bounds);
+        a.height = 1 + std::max(other.height, nodes[iMoved].height);
+        child.bounds = a.bounds.Union(nodes[iKept].bounds);
+        child.height = 1 + std::max(a.height, nodes[iKept].height);
+        return iChild;
+    };
+
+    if (balance > 1) {
+        return rotateUp(iC, c, a.child2, b);
+    }
+    if (balance < -1) {
+        return rotateUp(iB, b, a.child1, c);
+    }
+    return iA;
+}
@@ -12,8 +12,8 @@
 // implementation file for registry, entity, component, system, and pool classes
 // -----------------------------------------------------------------------------
 #include "headers/ecs.h"
+#include "headers/logger.h"
 #include <algorithm>
-#include <spdlog/spdlog.h>
 
 
 // _____________________________________________________________________________
@@ -22,7 +22,6 @@
 // holds data of an entity, to be manipulated by systems
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
-int IComponent::nextId = 0;
 
 
 // _____________________________________________________________________________
@@ -35,10 +34,18 @@ int Entity::GetId() const {
     return id;
 }
 
+int Entity::GetGeneration() const {
+    return generation;
+}
+
 void Entity::Kill() {
     registry->KillEntity(*this);
 }
 
+bool Entity::IsAlive() const {
+    return registry->IsAlive(*this);
+}
+
 void Entity::Tag(const std::string& tag) {
     registry->TagEntity(*this, tag);
 }
@@ -63,23 +70,390 @@ bool Entity::BelongsToGroup(const std::string& group) const {
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
 void System::AddEntityToSystem(Entity entity) {
+    const auto entityId = entity.GetId();
+    if (entityId >= static_cast<int>(entityIndices.size())) {
+        entityIndices.resize(entityId + 1, -1);
+    }
+    if (entityIndices[entityId] != -1) {
+        return;
+    }
+
+    entityIndices[entityId] = static_cast<int>(entities.size());
     entities.push_back(entity);
 }
 
+void System::AddEntitiesToSystem(std::span<const Entity> newEntities) {
+    int maxEntityId = -1;
+    for (const auto& entity : newEntities) {
+        maxEntityId = std::max(maxEntityId, entity.GetId());
+    }
+    if (maxEntityId >= static_cast<int>(entityIndices.size())) {
+        entityIndices.resize(maxEntityId + 1, -1);
+    }
+
+    entities.reserve(entities.size() + newEntities.size());
+    for (const auto& entity : newEntities) {
+        if (entityIndices[entity.GetId()] == -1) {
+            entityIndices[entity.GetId()] = static_cast<int>(entities.size());
+            entities.push_back(entity);
+        }
+    }
+}
+
 void System::RemoveEntityFromSystem(Entity entity) {
-    entities.erase(std::remove_if(entities.begin(), entities.end(), [&entity](Entity other) {
-        return entity == other;
-    }), entities.end());
+    if (!HasEntity(entity)) {
+        return;
+    }
+
+    // move the last member into the removed slot to keep the vector packed
+    const int index = entityIndices[entity.GetId()];
+    const Entity last = entities.back();
+    entities[index] = last;
+    entityIndices[last.GetId()] = index;
+
+    entityIndices[entity.GetId()] = -1;
+    entities.pop_back();
+}
+
+bool System::HasEntity(Entity entity) const {
+    const auto entityId = entity.GetId();
+    return entityId < static_cast<int>(entityIndices.size()) && entityIndices[entityId] != -1 &&
+        entities[entityIndices[entityId]] == entity;
 }
 
 std::vector<Entity> System::GetSystemEntities() const {
     return entities;
 }
 
+std::span<const Entity> System::GetSystemEntitiesSpan() const {
+    return entities;
+}
+
 const Signature& System::GetComponentSignature() const {
     return componentSignature;
 }
 
+void System::RequireExclusiveAccess() {
+    isExclusive = true;
+}
+
+const Signature& System::GetReadSignature() const {
+    return readSignature;
+}
+
+const Signature& System::GetWriteSignature() const {
+    return writeSignature;
+}
+
+bool System::IsExclusive() const {
+    return isExclusive;
+}
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// MEMORY ARENA
+// registry-owned memory the component storage carves its chunks from
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+MemoryArena::~MemoryArena() {
+    for (const auto& block : blocks) {
+        ::operator delete(block.memory, std::align_val_t(ALIGNMENT));
+    }
+}
+
+void* MemoryArena::Allocate(size_t bytes) {
+    bytes = RoundUp(bytes);
+    bytesAllocated += bytes;
+
+    auto freeList = freeLists.find(bytes);
+    if (freeList != freeLists.end() && !freeList->second.empty()) {
+        void* memory = freeList->second.back();
+        freeList->second.pop_back();
+        return memory;
+    }
+
+    if (blocks.empty() || blocks.back().size - blockUsed < bytes) {
+        AddBlock(bytes);
+    }
+    void* memory = blocks.back().memory + blockUsed;
+    blockUsed += bytes;
+    return memory;
+}
+
+void MemoryArena::Free(void* memory, size_t bytes) {
+    bytes = RoundUp(bytes);
+    bytesAllocated -= bytes;
+    freeLists[bytes].push_back(memory);
+}
+
+void MemoryArena::Reserve(size_t bytes) {
+    bytes = RoundUp(bytes);
+    if (blocks.empty() || blocks.back().size - blockUsed < bytes) {
+        AddBlock(bytes);
+    }
+}
+
+void MemoryArena::AddBlock(size_t bytes) {
+    // the rest of the current block is abandoned, blocks are sized so that stays small
+    const size_t size = std::max(BLOCK_BYTES, RoundUp(bytes));
+    blocks.push_back({static_cast<std::byte*>(::operator new(size, std::align_val_t(ALIGNMENT))), size});
+    blockUsed = 0;
+    bytesReserved += size;
+}
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// POOL STORAGE
+// component storage backend with one sparse set pool per component type
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+void PoolStorage::RemoveEntity(int entityId, const Signature& signature) {
+    // only the pools flagged in the entity signature can hold one of its components
+    signature.ForEachSetBit([&](int componentId) {
+        if (componentId < static_cast<int>(componentPools.size()) && componentPools[componentId]) {
+            componentPools[componentId]->RemoveEntityFromPool(entityId);
+        }
+    });
+}
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// ARCHETYPE
+// all entities with the same signature, stored in fixed-size chunks of SoA columns
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+static size_t AlignUp(size_t offset, size_t alignment) {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+Archetype::Archetype(const Signature& signature, const std::vector<ComponentTypeInfo>& typeInfos, MemoryArena& arena): signature(signature), arena(&arena) {
+    columnOfComponent.assign(MAX_COMPONENTS, -1);
+    addEdges.assign(MAX_COMPONENTS, nullptr);
+    removeEdges.assign(MAX_COMPONENTS, nullptr);
+
+    // one column per component in the signature, plus the entity id array
+    size_t bytesPerRow = sizeof(int);
+    signature.ForEachSetBit([&](int componentId) {
+        columnOfComponent[componentId] = static_cast<int>(columns.size());
+        columns.push_back({componentId, 0, typeInfos[componentId]});
+        bytesPerRow += typeInfos[componentId].size;
+    });
+
+    // fit as many rows as possible in a chunk, shrinking until the column padding fits too
+    chunkCapacity = std::max<int>(1, CHUNK_BYTES / bytesPerRow);
+    size_t layoutBytes = 0;
+    while (true) {
+        layoutBytes = sizeof(int) * chunkCapacity;
+        for (auto& column : columns) {
+            layoutBytes = AlignUp(layoutBytes, column.info.alignment);
+            column.offset = layoutBytes;
+            layoutBytes += column.info.size * chunkCapacity;
+        }
+        if (layoutBytes <= CHUNK_BYTES || chunkCapacity == 1) {
+            break;
+        }
+        chunkCapacity--;
+    }
+
+    // a single row of huge components can exceed the default chunk size
+    chunkBytes = std::max(CHUNK_BYTES, AlignUp(layoutBytes, MemoryArena::ALIGNMENT));
+}
+
+Archetype::~Archetype() {
+    for (int row = 0; row < size; row++) {
+        for (const auto& column : columns) {
+            column.info.destroy(GetComponent(row, column.componentId));
+        }
+    }
+    for (auto chunk : chunks) {
+        FreeChunk(chunk);
+    }
+}
+
+std::byte* Archetype::AllocateChunk() {
+    return static_cast<std::byte*>(arena->Allocate(chunkBytes));
+}
+
+void Archetype::FreeChunk(std::byte* chunk) {
+    arena->Free(chunk, chunkBytes);
+}
+
+int Archetype::AllocateRow(int entityId) {
+    if (size == static_cast<int>(chunks.size()) * chunkCapacity) {
+        chunks.push_back(AllocateChunk());
+        growEvents++;
+    }
+
+    const int row = size++;
+    highWaterMark = std::max(highWaterMark, size);
+    reinterpret_cast<int*>(chunks[row / chunkCapacity])[row % chunkCapacity] = entityId;
+    return row;
+}
+
+void Archetype::Reserve(int rows) {
+    while (static_cast<int>(chunks.size()) * chunkCapacity < rows) {
+        chunks.push_back(AllocateChunk());
+    }
+}
+
+int Archetype::RemoveRow(int row) {
+    const int lastRow = size - 1;
+    int movedEntityId = -1;
+
+    for (const auto& column : columns) {
+        column.info.destroy(GetComponent(row, column.componentId));
+    }
+
+    // move the last row into the hole to keep the chunks packed
+    if (row != lastRow) {
+        for (const auto& column : columns) {
+            void* last = GetComponent(lastRow, column.componentId);
+            column.info.moveConstruct(GetComponent(row, column.componentId), last);
+            column.info.destroy(last);
+        }
+        movedEntityId = GetEntityIds(lastRow / chunkCapacity)[lastRow % chunkCapacity];
+        reinterpret_cast<int*>(chunks[row / chunkCapacity])[row % chunkCapacity] = movedEntityId;
+    }
+    size--;
+
+    // release trailing chunks once two of them are empty (keeping one spare avoids thrashing)
+    if (static_cast<int>(chunks.size()) * chunkCapacity - size >= 2 * chunkCapacity) {
+        FreeChunk(chunks.back());
+        chunks.pop_back();
+    }
+
+    return movedEntityId;
+}
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// ARCHETYPE STORAGE
+// component storage backend that groups entities by signature (see Archetype)
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+ArchetypeStorage::EntityLocation& ArchetypeStorage::GetLocation(int entityId) {
+    if (entityId >= static_cast<int>(entityLocations.size())) {
+        entityLocations.resize(entityId + 1);
+    }
+    return entityLocations[entityId];
+}
+
+void ArchetypeStorage::ReservePending() {
+    if (pendingReserveBytes == 0 || pendingReserveRows == 0) {
+        pendingReserveBytes = 0;
+        pendingReserveTypes = 0;
+        return;
+    }
+
+    // sized as if the reserved types shared one archetype: the rows also hold an entity id, a chunk
+    // loses up to a row to rounding, and the entities pass through an archetype per type added
+    const size_t rows = static_cast<size_t>(pendingReserveRows);
+    const size_t rowBytes = pendingReserveBytes / rows + sizeof(int);
+    const size_t rowsPerChunk = std::max<size_t>(1, Archetype::CHUNK_BYTES / rowBytes);
+    const size_t chunks = (rows + rowsPerChunk - 1) / rowsPerChunk + pendingReserveTypes;
+    arena->Reserve(chunks * std::max(Archetype::CHUNK_BYTES, rowBytes));
+
+    pendingReserveBytes = 0;
+    pendingReserveRows = 0;
+    pendingReserveTypes = 0;
+}
+
+Archetype* ArchetypeStorage::GetArchetype(const Signature& signature) {
+    // entities without components don't live in any archetype
+    if (signature.None()) {
+        return nullptr;
+    }
+
+    auto archetype = archetypes.find(signature);
+    if (archetype != archetypes.end()) {
+        return archetype->second.get();
+    }
+
+    auto newArchetype = std::make_unique<Archetype>(signature, componentTypeInfos, *arena);
+    Archetype* result = newArchetype.get();
+    archetypes.emplace(signature, std::move(newArchetype));
+    archetypeList.push_back(result);
+    return result;
+}
+
+Archetype* ArchetypeStorage::GetAddTarget(Archetype* source, int componentId) {
+    if (source && source->addEdges[componentId]) {
+        return source->addEdges[componentId];
+    }
+
+    Signature signature = source ? source->GetSignature() : Signature();
+    signature.Set(componentId);
+    Archetype* target = GetArchetype(signature);
+
+    if (source) {
+        source->addEdges[componentId] = target;
+        target->removeEdges[componentId] = source;
+    }
+    return target;
+}
+
+Archetype* ArchetypeStorage::GetRemoveTarget(Archetype* source, int componentId) {
+    if (source->removeEdges[componentId]) {
+        return source->removeEdges[componentId];
+    }
+
+    Signature signature = source->GetSignature();
+    signature.Reset(componentId);
+    Archetype* target = GetArchetype(signature);
+
+    if (target) {
+        source->removeEdges[componentId] = target;
+        target->addEdges[componentId] = source;
+    }
+    return target;
+}
+
+void ArchetypeStorage::MoveEntity(int entityId, Archetype* target) {
+    EntityLocation& location = GetLocation(entityId);
+    Archetype* source = location.archetype;
+    if (source == target) {
+        return;
+    }
+
+    int newRow = -1;
+    if (target) {
+        newRow = target->AllocateRow(entityId);
+
+        // move over every component both archetypes have in common
+        if (source) {
+            const Signature shared = source->GetSignature() & target->GetSignature();
+            shared.ForEachSetBit([&](int componentId) {
+                componentTypeInfos[componentId].moveConstruct(
+                    target->GetComponent(newRow, componentId),
+                    source->GetComponent(location.row, componentId)
+                );
+            });
+        }
+    }
+
+    if (source) {
+        // the old row is destroyed and backfilled by the source archetype's last entity
+        const int movedEntityId = source->RemoveRow(location.row);
+        if (movedEntityId != -1) {
+            entityLocations[movedEntityId].row = location.row;
+        }
+    }
+
+    location.archetype = target;
+    location.row = newRow;
+}
+
+void ArchetypeStorage::RemoveEntity(int entityId, const Signature& signature) {
+    // entities without components don't live in any archetype
+    if (!signature.None() && entityId < static_cast<int>(entityLocations.size())) {
+        MoveEntity(entityId, nullptr);
+    }
+}
+
 
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
@@ -88,53 +462,102 @@ const Signature& System::GetComponentSignature() const {
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
 Entity Registry::CreateEntity() {
+    Entity entity = AllocateEntity();
+    entityComponentSignatures.resize(entitySlots.size());
+    FlagForUpdate(entity);
+    LOG_DEBUG(LogCategory::ECS, "Entity created with id = {}", entity.GetId());
+
+    return entity;
+}
+
+Entity Registry::AllocateEntity() {
     int entityId;
 
-    if (freeIds.empty()) {
+    if (firstFreeId == NO_FREE_ID) {
         // if there are no free Ids waiting to be reused, expand and resize
-        entityId = numEntities++;
-        if (entityId >= entityComponentSignatures.size()) {
-            entityComponentSignatures.resize(entityId + 1);
-        }
+        entityId = static_cast<int>(entitySlots.size());
+        entitySlots.emplace_back();
     }
     else {
-        // reuse an id from the list of previously removed entities
-        entityId = freeIds.front();
-        freeIds.pop_front();
+        // reuse an id from the free list (its generation was bumped when it was freed)
+        entityId = firstFreeId;
+        firstFreeId = entitySlots[entityId].nextFreeId;
+        entitySlots[entityId].nextFreeId = ENTITY_ALIVE;
     }
 
-    Entity entity(entityId);
+    Entity entity(entityId, entitySlots[entityId].generation);
     entity.registry = this;
-    entitiesToBeAdded.insert(entity);
-    spdlog::info("Entity created with id = " + std::to_string(entityId));
-
     return entity;
 }
 
 void Registry::KillEntity(Entity entity) {
-    entitiesToBeKilled.insert(entity);
-    spdlog::info("Entity " + std::to_string(entity.GetId()) + " was killed");
+    if (!IsAlive(entity)) {
+        LOG_WARN(LogCategory::ECS, "Ignoring kill of stale entity {}", entity.GetId());
+        return;
+    }
+    std::lock_guard<std::mutex> lock(killMutex);
+    EntitySlot& slot = entitySlots[entity.GetId()];
+    if (!slot.isFlaggedForKill) {
+        slot.isFlaggedForKill = true;
+        entitiesToBeKilled.push_back(entity);
+    }
+    LOG_DEBUG(LogCategory::ECS, "Entity {} was killed", entity.GetId());
+}
+
+bool Registry::IsAlive(Entity entity) const {
+    const auto entityId = entity.GetId();
+    return entityId >= 0 && entityId < static_cast<int>(entitySlots.size()) &&
+        entitySlots[entityId].nextFreeId == ENTITY_ALIVE &&
+        entitySlots[entityId].generation == entity.GetGeneration();
+}
+
+const Signature& Registry::GetEntitySignature(Entity entity) const {
+    static const Signature emptySignature;
+    return IsAlive(entity) ? entityComponentSignatures[entity.GetId()] : emptySignature;
+}
+
+Entity Registry::GetEntityById(int entityId) const {
+    Entity entity(entityId, entitySlots[entityId].generation);
+    entity.registry = const_cast<Registry*>(this);
+    return entity;
 }
 
 void Registry::AddEntityToSystems(Entity entity) {
     const auto entityId = entity.GetId();
 
     const auto& entityComponentSignature = entityComponentSignatures[entityId];
-    
-    for (auto& system: systems) {
-        const auto& systemComponentSignature = system.second->GetComponentSignature();
 
-        bool isInterested = (entityComponentSignature & systemComponentSignature) == systemComponentSignature;
-
-        if (isInterested) {
-            system.second->AddEntityToSystem(entity);
+    for (size_t i = 0; i < systemSignatures.size(); i++) {
+        if (entityComponentSignature.Includes(systemSignatures[i])) {
+            systemList[i]->AddEntityToSystem(entity);
         }
     }
 }
 
 void Registry::RemoveEntityFromSystems(Entity entity) {
-    for (auto system : systems) {
-        system.second->RemoveEntityFromSystem(entity);
+    for (auto system : systemList) {
+        system->RemoveEntityFromSystem(entity);
+    }
+}
+
+void Registry::UpdateEntityInSystems(Entity entity) {
+    const auto& entityComponentSignature = entityComponentSignatures[entity.GetId()];
+
+    for (size_t i = 0; i < systemSignatures.size(); i++) {
+        if (entityComponentSignature.Includes(systemSignatures[i])) {
+            systemList[i]->AddEntityToSystem(entity);
+        }
+        else {
+            systemList[i]->RemoveEntityFromSystem(entity);
+        }
+    }
+}
+
+void Registry::FlagForUpdate(Entity entity) {
+    EntitySlot& slot = entitySlots[entity.GetId()];
+    if (!slot.isFlaggedForUpdate) {
+        slot.isFlaggedForUpdate = true;
+        entitiesToBeUpdated.push_back(entity);
     }
 }
 
@@ -173,8 +596,8 @@ bool Registry::EntityBelongsToGroup(Entity entity, const std::string& group) con
     if (entitiesPerGroup.find(group) == entitiesPerGroup.end()) {
         return false;
     }
-	auto groupEntities = entitiesPerGroup.at(group);
-    return groupEntities.find(entity.GetId()) != groupEntities.end();
+	const auto& groupEntities = entitiesPerGroup.at(group);
+    return groupEntities.find(entity) != groupEntities.end();
 }
 
 std::vector<Entity> Registry::GetEntitiesByGroup(const std::string& group) const {
@@ -198,26 +621,43 @@ void Registry::RemoveEntityGroup(Entity entity) {
 }
 
 void Registry::Update() {
-    // process the entities that are waiting to be created to the active Systems
-    for (auto entity : entitiesToBeAdded) {
-        AddEntityToSystems(entity);
+    // hand every batch created in bulk to its matching systems in one go
+    for (const auto& batch : batchesToBeAdded) {
+        for (size_t i = 0; i < systemSignatures.size(); i++) {
+            if (batch.signature.Includes(systemSignatures[i])) {
+                systemList[i]->AddEntitiesToSystem(batch.entities);
+            }
+        }
     }
-    entitiesToBeAdded.clear();
+    batchesToBeAdded.clear();
+
+    // process the entities that were created, or gained/lost components, against the active systems
+    for (auto entity : entitiesToBeUpdated) {
+        entitySlots[entity.GetId()].isFlaggedForUpdate = false;
+        if (IsAlive(entity)) {
+            UpdateEntityInSystems(entity);
+        }
+    }
+    entitiesToBeUpdated.clear();
 
     // process the entities that are waiting to be killed from active systems
     for (auto entity : entitiesToBeKilled) {
+        entitySlots[entity.GetId()].isFlaggedForKill = false;
+        if (!IsAlive(entity)) {
+            continue;
+        }
+
         RemoveEntityFromSystems(entity);
-        entityComponentSignatures[entity.GetId()].reset();
 
-        // remove the entity from the component pools
-        for (auto pool : componentPools) {
-            if (pool) {
-                pool->RemoveEntityFromPool(entity.GetId());
-            }
-        }
+        // remove the entity's components from the storage backend
+        componentStorage.RemoveEntity(entity.GetId(), entityComponentSignatures[entity.GetId()]);
+        entityComponentSignatures[entity.GetId()].Reset();
 
-        // make the entity id available to be reused
-        freeIds.push_back(entity.GetId());
+        // invalidate every handle to this entity and make its id available to be reused right away
+        EntitySlot& slot = entitySlots[entity.GetId()];
+        slot.generation++;
+        slot.nextFreeId = firstFreeId;
+        firstFreeId = entity.GetId();
 
         // remove any traces of that entity from the tag/group maps
         RemoveEntityTag(entity);
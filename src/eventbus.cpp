@@ -0,0 +1,55 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// eventbus.cpp
+// implementation file for the Event Bus stats
+// -----------------------------------------------------------------------------
+#include "headers/eventbus.h"
+
+void EventCounters::Add(const EventCounters& other) {
+    emits += other.emits;
+    queued += other.queued;
+    maxQueueDepth = std::max(maxQueueDepth, other.maxQueueDepth);
+    invocations += other.invocations;
+    handlerTime += other.handlerTime;
+    maxHandlerTime = std::max(maxHandlerTime, other.maxHandlerTime);
+}
+
+void EventBus::OpenStatsCsv(const std::string& path) {
+    if constexpr (ENGINE_EVENT_STATS) {
+        statsCsv.open(path);
+        if (!statsCsv) {
+            LOG_ERROR(LogCategory::Events, "Could not open the event stats file {}", path);
+            return;
+        }
+        statsCsv << "frame,event,emits,queued,max_queue_depth,invocations,handler_time_us,max_handler_time_us\n";
+    }
+}
+
+void EventBus::EndFrame() {
+    if constexpr (ENGINE_EVENT_STATS) {
+        for (size_t eventId = 0; eventId < stats.size(); eventId++) {
+            EventStats& eventStats = stats[eventId];
+            const EventCounters& counters = frameCounters[eventId];
+            eventStats.lastFrame = counters;
+            eventStats.total.Add(counters);
+
+            if (statsCsv.is_open()) {
+                statsCsv << frame << ',' << eventStats.eventName << ','
+                    << counters.emits << ',' << counters.queued << ',' << counters.maxQueueDepth << ','
+                    << counters.invocations << ','
+                    << std::chrono::duration<double, std::micro>(counters.handlerTime).count() << ','
+                    << std::chrono::duration<double, std::micro>(counters.maxHandlerTime).count() << '\n';
+            }
+        }
+        frameCounters.fill({});
+        frame++;
+    }
+}
@@ -21,6 +21,7 @@
 #include "headers/keyboardcontrolledcomponent.h"
 #include "headers/camerafollowcomponent.h"
 #include "headers/projectileemittercomponent.h"
+#include "headers/projectilecomponent.h"
 #include "headers/healthcomponent.h"
 #include "headers/textlabelcomponent.h"
 #include "headers/movementsystem.h"
@@ -35,10 +36,10 @@
 #include "headers/projectilelifecyclesystem.h"
 #include "headers/rendertextsystem.h"
 #include "headers/renderhealthbarsystem.h"
+#include "headers/logger.h"
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_image.h>
 #include <glm/glm.hpp>
-#include <spdlog/spdlog.h>
 #include <iostream>
 #include <fstream>
 
@@ -53,21 +54,23 @@ Game::Game() {
     registry = std::make_unique<Registry>();
     assetStore = std::make_unique<AssetStore>();
     eventBus = std::make_unique<EventBus>();
-    spdlog::info("Game constructor called!");
+    threadPool = std::make_unique<ThreadPool>();
+    scheduler = std::make_unique<SystemScheduler>(*threadPool);
+    LOG_INFO(LogCategory::Engine, "Game constructor called!");
 }
 
 Game::~Game() {
-    spdlog::info("Game destructor called!");   
+    LOG_INFO(LogCategory::Engine, "Game destructor called!");   
 }
 
 void Game::Initialize() {
     if (SDL_Init(SDL_INIT_EVERYTHING) != 0) {
-        spdlog::error("Error initializing SDL.");
+        LOG_ERROR(LogCategory::Engine, "Error initializing SDL.");
         return;
     }
 
     if (TTF_Init() != 0) {
-        spdlog::error("Error initializing SDL TTF.");
+        LOG_ERROR(LogCategory::Engine, "Error initializing SDL TTF.");
         return;
     }
 
@@ -84,12 +87,12 @@ void Game::Initialize() {
         SDL_WINDOW_BORDERLESS
     );
     if (!window) {
-        spdlog::error("Error creating SDL window.");
+        LOG_ERROR(LogCategory::Engine, "Error creating SDL window.");
         return;
     }
     renderer = SDL_CreateRenderer(window, -1, 0);
     if (!renderer) {
-        spdlog::error("Error creating SDL renderer.");
+        LOG_ERROR(LogCategory::Engine, "Error creating SDL renderer.");
         return;
     }
     SDL_SetWindowFullscreen(window, SDL_WINDOW_FULLSCREEN);
@@ -154,6 +157,20 @@ void Game::LoadLevel(int level) {
     int mapNumCols = 25;
     int mapNumRows = 20;
 
+    // pre-size the pools of the components the tiles, actors and projectiles use,
+    // so a projectile burst doesn't grow a pool in the middle of a frame
+    const int maxActors = 16;
+    const int maxProjectiles = 256;
+    registry->ReservePool<TransformComponent>(mapNumRows * mapNumCols + maxActors + maxProjectiles);
+    registry->ReservePool<SpriteComponent>(mapNumRows * mapNumCols + maxActors + maxProjectiles);
+    registry->ReservePool<RigidBodyComponent>(maxActors + maxProjectiles);
+    registry->ReservePool<BoxColliderComponent>(maxActors + maxProjectiles);
+    registry->ReservePool<ProjectileComponent>(maxProjectiles);
+
+    // read the source rect of every tile first, then create all the tiles in one batch
+    std::vector<std::pair<int, int>> tileSrcRects;
+    tileSrcRects.reserve(mapNumRows * mapNumCols);
+
     std::fstream mapFile;
     mapFile.open("./assets/tilemaps/jungle.map");
 
@@ -167,13 +184,44 @@ void Game::LoadLevel(int level) {
             // skip comma
             mapFile.ignore();
 
-            Entity tile = registry->CreateEntity();
-            tile.Group("tiles");
-            tile.AddComponent<TransformComponent>(glm::vec2(x * (tileScale * tileSize), y * (tileScale * tileSize)), glm::vec2(tileScale, tileScale), 0.0);
-            tile.AddComponent<SpriteComponent>("tilemap-image", tileSize, tileSize, 0, false, srcRectX, srcRectY);
+            tileSrcRects.emplace_back(srcRectX, srcRectY);
         }
     }
     mapFile.close();
+
+    std::vector<Entity> tiles = registry->CreateEntities(
+        mapNumRows * mapNumCols,
+        [&](int i) {
+            int x = i % mapNumCols;
+            int y = i / mapNumCols;
+            return TransformComponent(glm::vec2(x * (tileScale * tileSize), y * (tileScale * tileSize)), glm::vec2(tileScale, tileScale), 0.0);
+        },
+        [&](int i) {
+            return SpriteComponent("tilemap-image", tileSize, tileSize, 0, false, tileSrcRects[i].first, tileSrcRects[i].second);
+        }
+    );
+    for (auto& tile : tiles) {
+        tile.Group("tiles");
+    }
+
+    // each level picks the collision broadphase that suits its colliders: this one has a few
+    // actors and bursts of small projectiles, so a grid with cells one map tile wide
+    BroadphaseSettings broadphase;
+    broadphase.type = BroadphaseType::SpatialHash;
+    broadphase.cellSize = tileSize * tileScale;
+    registry->GetSystem<CollisionSystem>().SetBroadphase(broadphase);
+
+    // bullets only hit the other side (and walls), never each other nor their own side
+    CollisionLayerMatrix layers;
+    layers.ClearLayer(CollisionLayer::PlayerBullet);
+    layers.ClearLayer(CollisionLayer::EnemyBullet);
+    layers.SetCollides(CollisionLayer::PlayerBullet, CollisionLayer::Enemy, true);
+    layers.SetCollides(CollisionLayer::PlayerBullet, CollisionLayer::Static, true);
+    layers.SetCollides(CollisionLayer::EnemyBullet, CollisionLayer::Player, true);
+    layers.SetCollides(CollisionLayer::EnemyBullet, CollisionLayer::Static, true);
+    layers.SetCollides(CollisionLayer::Static, CollisionLayer::Static, false);
+    registry->GetSystem<CollisionSystem>().SetLayerMatrix(layers);
+
     mapWidth = mapNumCols * tileSize * tileScale;
     mapHeight = mapNumRows * tileSize * tileScale;
 
@@ -184,7 +232,7 @@ void Game::LoadLevel(int level) {
     chopper.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 0.0));
     chopper.AddComponent<SpriteComponent>("chopper-image", 32, 32, 1);
     chopper.AddComponent<AnimationComponent>(2, 10, true);
-    chopper.AddComponent<BoxColliderComponent>(32, 32);
+    chopper.AddComponent<BoxColliderComponent>(32, 32, glm::vec2(0), CollisionLayer::Player);
     chopper.AddComponent<ProjectileEmitterComponent>(glm::vec2(150.0, 150.0), 0, 10000, 10, true);
     chopper.AddComponent<KeyboardControlledComponent>(glm::vec2(0, -80), glm::vec2(80, 0), glm::vec2(0, 80), glm::vec2(-80, 0));
     chopper.AddComponent<CameraFollowComponent>();
@@ -201,7 +249,7 @@ void Game::LoadLevel(int level) {
     tank.AddComponent<TransformComponent>(glm::vec2(500.0, 10.0), glm::vec2(1.0, 1.0), 45.0);
     tank.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 0.0));
     tank.AddComponent<SpriteComponent>("tank-image", 32, 32, 2);
-    tank.AddComponent<BoxColliderComponent>(32, 32);
+    tank.AddComponent<BoxColliderComponent>(32, 32, glm::vec2(0), CollisionLayer::Enemy);
     tank.AddComponent<ProjectileEmitterComponent>(glm::vec2(100.0, 0.0), 5000, 3000, 10, false);
     tank.AddComponent<HealthComponent>(100);
 
@@ -210,7 +258,7 @@ void Game::LoadLevel(int level) {
     truck.AddComponent<TransformComponent>(glm::vec2(10.0, 10.0), glm::vec2(1.0, 1.0), 0.0);
     truck.AddComponent<RigidBodyComponent>(glm::vec2(0.0, 0.0));
     truck.AddComponent<SpriteComponent>("truck-image", 32, 32, 1);
-    truck.AddComponent<BoxColliderComponent>(32, 32);
+    truck.AddComponent<BoxColliderComponent>(32, 32, glm::vec2(0), CollisionLayer::Enemy);
     truck.AddComponent<ProjectileEmitterComponent>(glm::vec2(0.0, 100.0), 2000, 5000, 10, false);
     truck.AddComponent<HealthComponent>(100);
 
@@ -221,6 +269,15 @@ void Game::LoadLevel(int level) {
 
 void Game::Setup() {
     LoadLevel(1);
+
+    // subscriptions persist, so the systems only subscribe to their events once
+    registry->GetSystem<DamageSystem>().SubscribeToEvents(eventBus);
+    registry->GetSystem<KeyboardControlSystem>().SubscribeToEvents(eventBus);
+    registry->GetSystem<ProjectileEmitSystem>().SubscribeToEvents(eventBus);
+
+    if constexpr (ENGINE_EVENT_STATS) {
+        eventBus->OpenStatsCsv("event_stats.csv");
+    }
 }
 
 void Game::Update() {
@@ -236,21 +293,25 @@ void Game::Update() {
     // store the "previous" frame time
     millisecsPreviousFrame = SDL_GetTicks();
 
-    // reset all event handlers for the current frame
-    eventBus->Reset();
-
-    // perform subscription of the events for all systems
-    registry->GetSystem<DamageSystem>().SubscribeToEvents(eventBus);
-    registry->GetSystem<KeyboardControlSystem>().SubscribeToEvents(eventBus);
-    registry->GetSystem<ProjectileEmitSystem>().SubscribeToEvents(eventBus);
-    
-    // ask all the systems to update
-    registry->GetSystem<MovementSystem>().Update(deltaTime);
-    registry->GetSystem<AnimationSystem>().Update();
-    registry->GetSystem<CollisionSystem>().Update(eventBus);
-    registry->GetSystem<ProjectileEmitSystem>().Update(registry);
-    registry->GetSystem<CameraMovementSystem>().Update(camera);
-    registry->GetSystem<ProjectileLifecycleSystem>().Update();
+    // ask all the systems to update, the scheduler runs the ones that don't conflict at the same time
+    // (e.g. movement, animation and projectile lifecycle together, collision once they are all done)
+    auto& movementSystem = registry->GetSystem<MovementSystem>();
+    auto& animationSystem = registry->GetSystem<AnimationSystem>();
+    auto& projectileLifecycleSystem = registry->GetSystem<ProjectileLifecycleSystem>();
+    auto& cameraMovementSystem = registry->GetSystem<CameraMovementSystem>();
+    auto& collisionSystem = registry->GetSystem<CollisionSystem>();
+    auto& projectileEmitSystem = registry->GetSystem<ProjectileEmitSystem>();
+    scheduler->Add(movementSystem, [&]() { movementSystem.Update(registry, deltaTime, *threadPool); });
+    scheduler->Add(animationSystem, [&]() { animationSystem.Update(registry); });
+    scheduler->Add(projectileLifecycleSystem, [&]() { projectileLifecycleSystem.Update(); });
+    scheduler->Add(cameraMovementSystem, [&]() { cameraMovementSystem.Update(camera); });
+    scheduler->Add(collisionSystem, [&]() { collisionSystem.Update(eventBus, *threadPool); });
+    scheduler->Add(projectileEmitSystem, [&]() { projectileEmitSystem.Update(registry); });
+    scheduler->Run();
+
+    // hand the events queued during the systems update to their handlers (e.g. collisions to the damage system)
+    eventBus->Flush();
+    eventBus->EndFrame();
 
     // update the registry to process the entities that are awaiting creation/deletion
     registry->Update();
@@ -264,6 +325,14 @@ void Game::Render() {
     registry->GetSystem<RenderSystem>().Update(renderer, assetStore, camera);
     registry->GetSystem<RenderTextSystem>().Update(renderer, assetStore, camera);
     registry->GetSystem<RenderHealthBarSystem>().Update(renderer, assetStore, camera);
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_DEBUG
+    // the culling stats are only looked up when the debug log is compiled in
+    const auto& sprites = registry->GetSystem<RenderSystem>().GetCullingStats();
+    const auto& labels = registry->GetSystem<RenderTextSystem>().GetCullingStats();
+    const auto& healthBars = registry->GetSystem<RenderHealthBarSystem>().GetCullingStats();
+    LOG_DEBUG_EVERY(LogCategory::Engine, 1000, "Drew {} sprites ({} culled), {} labels ({} culled), {} health bars ({} culled)",
+        sprites.visible, sprites.culled, labels.visible, labels.culled, healthBars.visible, healthBars.culled);
+#endif
     if (isDebug) {
         registry->GetSystem<RenderColliderSystem>().Update(renderer, camera);
     }
@@ -0,0 +1,77 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// aabb.h
+// header file for the axis-aligned bounding box shared by the collision code
+// -----------------------------------------------------------------------------
+#ifndef AABB_H
+#define AABB_H
+
+#include "transformcomponent.h"
+#include "boxcollidercomponent.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+struct AABB {
+    float minX;
+    float minY;
+    float maxX;
+    float maxY;
+
+    // bounds of a box collider; the max corner is the exact position + size rounded up to
+    // the next float, so the strict float tests below give the same answers as the exact
+    // (double) ones: a float min is below the exact max if and only if it is below the rounded up one
+    static AABB FromCollider(const TransformComponent& transform, const BoxColliderComponent& collider) {
+        const float minX = transform.position.x + collider.offset.x;
+        const float minY = transform.position.y + collider.offset.y;
+        return {minX, minY, RoundUp(static_cast<double>(minX) + collider.width), RoundUp(static_cast<double>(minY) + collider.height)};
+    }
+
+    // touching boxes don't overlap
+    bool Overlaps(const AABB& other) const {
+        return minX < other.maxX && maxX > other.minX && minY < other.maxY && maxY > other.minY;
+    }
+
+    bool Contains(const AABB& other) const {
+        return minX <= other.minX && minY <= other.minY && maxX >= other.maxX && maxY >= other.maxY;
+    }
+
+    bool operator ==(const AABB& other) const = default;
+
+    AABB Union(const AABB& other) const {
+        return {std::min(minX, other.minX), std::min(minY, other.minY), std::max(maxX, other.maxX), std::max(maxY, other.maxY)};
+    }
+
+    AABB Fattened(float margin) const {
+        return {minX - margin, minY - margin, maxX + margin, maxY + margin};
+    }
+
+    float Perimeter() const {
+        return 2.0f * ((maxX - minX) + (maxY - minY));
+    }
+
+private:
+    static float RoundUp(double value) {
+        const float rounded = static_cast<float>(value);
+        return static_cast<double>(rounded) < value ? std::nextafter(rounded, std::numeric_limits<float>::infinity()) : rounded;
+    }
+};
+
+// two colliders (indices into the bounds the broadphase was given), with a < b
+struct ColliderPair {
+    int a;
+    int b;
+
+    bool operator <(const ColliderPair& other) const { return a < other.a || (a == other.a && b < other.b); }
+    bool operator ==(const ColliderPair& other) const = default;
+};
+
+#endif
@@ -24,19 +24,19 @@ public:
     AnimationSystem() {
         RequireComponent<SpriteComponent>();
         RequireComponent<AnimationComponent>();
+        WritesComponent<SpriteComponent>();
+        WritesComponent<AnimationComponent>();
     }
 
-    void Update() {
-        for (auto entity : GetSystemEntities()) {
-            auto& animation = entity.GetComponent<AnimationComponent>();
-            auto& sprite = entity.GetComponent<SpriteComponent>();
-
+    void Update(std::unique_ptr<Registry>& registry) {
+        const auto ticks = SDL_GetTicks();
+        registry->View<SpriteComponent, AnimationComponent>().Each([ticks](Entity, SpriteComponent& sprite, AnimationComponent& animation) {
             // change the current frame
-            animation.currentFrame = ((SDL_GetTicks() - animation.startTime) * animation.frameSpeedRate / 1000) % animation.numFrames;
+            animation.currentFrame = ((ticks - animation.startTime) * animation.frameSpeedRate / 1000) % animation.numFrames;
 
             // change the src rectangle of the sprite (to next 'frame')
             sprite.srcRect.x = animation.currentFrame * sprite.width;
-        }
+        });
     }
 };
 
@@ -16,6 +16,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 
@@ -29,11 +30,20 @@ public:
     void AddTexture(SDL_Renderer* renderer, const std::string& assetId, const std::string& filePath);
     SDL_Texture* GetTexture(const std::string& assetId);
 
+    // a small number per texture (in the order they were added), stable until the assets are cleared:
+    // the renderer keys and fetches textures with it instead of the asset id string
+    // (-1 for an asset id that was never added, its texture is null)
+    int GetTextureHandle(const std::string& assetId) const;
+    SDL_Texture* GetTexture(int textureHandle) const;
+
     void AddFont(const std::string& assetId, const std::string& filePath, int fontSize);
     TTF_Font* GetFont(const std::string& assetId);
 
 private:
     std::map<std::string, SDL_Texture*> textures;
+    std::map<std::string, int> textureHandles;
+    // [Vector index = texture handle]
+    std::vector<SDL_Texture*> texturesByHandle;
     std::map<std::string, TTF_Font*> fonts;
 };
 
@@ -14,17 +14,23 @@
 #ifndef BOXCOLLIDERCOMPONENT_H
 #define BOXCOLLIDERCOMPONENT_H
 
+#include "collisionlayers.h"
 #include <glm/glm.hpp>
 
 struct BoxColliderComponent {
     int width;
     int height;
     glm::vec2 offset;
+    CollisionLayer layer;
+    // fast colliders (e.g. projectiles) are swept from their last position, so they can't skip through thin ones
+    bool isContinuous;
 
-    BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0)) {
+    BoxColliderComponent(int width = 0, int height = 0, glm::vec2 offset = glm::vec2(0), CollisionLayer layer = CollisionLayer::Default, bool isContinuous = false) {
         this->width = width;
         this->height = height;
         this->offset = offset;
+        this->layer = layer;
+        this->isContinuous = isContinuous;
     }
 };
 
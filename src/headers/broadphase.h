@@ -0,0 +1,207 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// broadphase.h
+// header file for the collision broadphase interface and its backends
+// -----------------------------------------------------------------------------
+#ifndef BROADPHASE_H
+#define BROADPHASE_H
+
+#include "aabb.h"
+#include "collisionlayers.h"
+#include "dynamicaabbtree.h"
+#include "threadpool.h"
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <span>
+#include <vector>
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// BROADPHASE
+// finds the pairs of colliders that may overlap, for the narrowphase to check
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+enum class BroadphaseType {
+    BruteForce,     // every pair, for small scenes and as the reference
+    SpatialHash,    // uniform grid, for many colliders of similar size
+    DynamicTree,    // bounding volume tree, for mixed sizes and mostly static colliders
+    SweepAndPrune   // intervals kept sorted on x across frames, for streams of moving colliders
+};
+
+struct BroadphaseSettings {
+    BroadphaseType type = BroadphaseType::SpatialHash;
+    float cellSize = 64.0f;         // spatial hash cell size
+    float treeMargin = 8.0f;        // how far a collider moves before its tree leaf is reinserted
+};
+
+// what the last FindPairs() did
+struct BroadphaseStats {
+    const char* name = "";
+    size_t colliders = 0;
+    size_t candidatePairs = 0;
+    size_t overlappingPairs = 0;    // candidates the narrowphase confirmed
+    std::chrono::nanoseconds findPairsTime{0};
+};
+
+// called with each collider a broadphase query found, context is the caller's (see IBroadphase::Query())
+using ColliderVisitor = void (*)(void* context, int collider);
+
+class IBroadphase {
+public:
+    virtual ~IBroadphase() = default;
+
+    virtual const char* GetName() const = 0;
+
+    // ids: a stable id per collider (e.g. its entity id), so backends can keep their
+    // structure from one frame to the next, bounds: the collider bounds this frame,
+    // filters: the collider layers, pairs of layers that don't collide are never returned
+    // [Span index = collider index]
+    // fills pairs with candidates (collider indices, a < b) sorted by (a, b), every
+    // overlapping pair of colliding layers exactly once; the search is split in chunks
+    // run on the thread pool, the pairs are the same whatever the number of threads
+    virtual void FindPairs(std::span<const int> ids, std::span<const AABB> bounds, std::span<const CollisionFilter> filters, std::vector<ColliderPair>& pairs, ThreadPool& threadPool) = 0;
+
+    // calls visit(context, collider) for the colliders of the last FindPairs() whose bounds may
+    // overlap area (every one that does, once): the broadphase isn't changed, so several threads
+    // may query at the same time, as long as FindPairs() isn't running
+    virtual void QueryArea(const AABB& area, ColliderVisitor visit, void* context) const = 0;
+
+    // calls func(collider) like QueryArea() does
+    template <typename TFunc>
+    void Query(const AABB& area, TFunc&& func) const {
+        using TFuncObject = std::remove_reference_t<TFunc>;
+        QueryArea(area, [](void* context, int collider) { (*static_cast<TFuncObject*>(context))(collider); }, const_cast<void*>(static_cast<const void*>(&func)));
+    }
+};
+
+std::unique_ptr<IBroadphase> CreateBroadphase(const BroadphaseSettings& settings);
+
+// colliders (or spatial hash buckets) searched per task
+constexpr size_t BROADPHASE_COLLIDERS_PER_CHUNK = 256;
+constexpr size_t BROADPHASE_BUCKETS_PER_CHUNK = 1024;
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// PAIR BUFFERS
+// one pair buffer per chunk of a parallel pair search, merged into the sorted pair list
+// (a buffer per chunk rather than per thread: which thread ran a chunk doesn't change the result)
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+class PairBuffers {
+public:
+    // chunkCount empty buffers, their memory is kept from the last frames
+    void Reset(size_t chunkCount);
+
+    // [Vector index = chunk index]
+    std::vector<ColliderPair>& GetChunk(size_t chunk) {return chunks[chunk];}
+
+    // merges the chunks (each sorted by (a, b)) into pairs, sorted, without duplicates
+    void Merge(std::vector<ColliderPair>& pairs, ThreadPool& threadPool);
+
+private:
+    std::vector<std::vector<ColliderPair>> chunks;
+    size_t chunkCount = 0;
+
+    // [Vector index = chunk index] where each chunk starts in the merged pairs
+    std::vector<size_t> chunkStarts;
+    std::vector<ColliderPair> mergeBuffer;
+};
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// BRUTE FORCE BROADPHASE
+// tests every pair, only the overlapping ones are returned
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+class BruteForceBroadphase : public IBroadphase {
+public:
+    const char* GetName() const override {return "brute force";}
+
+    // tests every pair of bounds (the ids aren't needed)
+    void FindPairs(std::span<const int> ids, std::span<const AABB> bounds, std::span<const CollisionFilter> filters, std::vector<ColliderPair>& pairs, ThreadPool& threadPool) override;
+    void QueryArea(const AABB& area, ColliderVisitor visit, void* context) const override;
+
+private:
+    // [Vector index = collider index] the bounds of the last FindPairs(), for the queries
+    std::vector<AABB> colliderBounds;
+
+    PairBuffers pairBuffers;
+};
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// TREE BROADPHASE
+// one dynamic tree leaf per collider, only reinserted once the collider leaves its fattened bounds
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+class TreeBroadphase : public IBroadphase {
+public:
+    explicit TreeBroadphase(float margin): tree(margin) {}
+
+    const char* GetName() const override {return "dynamic tree";}
+    void FindPairs(std::span<const int> ids, std::span<const AABB> bounds, std::span<const CollisionFilter> filters, std::vector<ColliderPair>& pairs, ThreadPool& threadPool) override;
+    void QueryArea(const AABB& area, ColliderVisitor visit, void* context) const override;
+
+private:
+    DynamicAABBTree tree;
+
+    // [Vector index = collider id]
+    std::vector<int> proxyOfId;
+    std::vector<uint32_t> frameSeen;
+
+    std::vector<int> trackedIds;
+    uint32_t frame = 0;
+
+    PairBuffers pairBuffers;
+};
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// SWEEP AND PRUNE BROADPHASE
+// collider x intervals kept sorted by min x across frames: colliders barely move
+// between frames, so the insertion sort that restores the order is close to linear
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+class SweepAndPruneBroadphase : public IBroadphase {
+public:
+    const char* GetName() const override {return "sweep and prune";}
+    void FindPairs(std::span<const int> ids, std::span<const AABB> bounds, std::span<const CollisionFilter> filters, std::vector<ColliderPair>& pairs, ThreadPool& threadPool) override;
+    void QueryArea(const AABB& area, ColliderVisitor visit, void* context) const override;
+
+private:
+    struct Interval {
+        float minX;
+        float maxX;
+        int id;
+        int index;
+    };
+
+    std::vector<Interval> intervals;
+    // widest interval, the queries start at the first one that can reach them
+    double maxWidth = 0.0;
+
+    // [Vector index = collider id]
+    std::vector<int> indexOfId;
+    std::vector<uint32_t> frameSeen;
+    std::vector<bool> isTracked;
+
+    uint32_t frame = 0;
+
+    PairBuffers pairBuffers;
+};
+
+#endif
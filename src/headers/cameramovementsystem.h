@@ -24,10 +24,12 @@ public:
     CameraMovementSystem() {
         RequireComponent<CameraFollowComponent>(); 
         RequireComponent<TransformComponent>(); 
+        ReadsComponent<CameraFollowComponent>();
+        ReadsComponent<TransformComponent>();
     }
 
     void Update(SDL_Rect& camera) {
-        for (auto entity : GetSystemEntities()) {
+        for (auto entity : GetSystemEntitiesSpan()) {
             auto transform = entity.GetComponent<TransformComponent>();
 
             if (transform.position.x + (camera.w / 2) < Game::mapWidth) {
@@ -9,19 +9,45 @@
 
 // -----------------------------------------------------------------------------
 // collisionevent.h
-// header file for Collision Event
+// header file for the Collision Events (begin, stay and end of a contact)
 // -----------------------------------------------------------------------------
 #ifndef COLLISIONEVENT_H
 #define COLLISIONEVENT_H
 
 #include "ecs.h"
 #include "event.h"
+#include <array>
 
+// the two entities of a contact, the base of the collision events (not an event type itself)
 class CollisionEvent : public Event {
 public:
     Entity a;
     Entity b;
     CollisionEvent(Entity a, Entity b) : a(a), b(b) {}
+
+    // the entities involved, used to route the event to filtered subscriptions
+    std::array<Entity, 2> GetEntities() const { return {a, b}; }
+};
+
+// two entities started touching this frame
+class CollisionBeginEvent : public CollisionEvent {
+public:
+    static constexpr const char* NAME = "CollisionBeginEvent";
+    using CollisionEvent::CollisionEvent;
+};
+
+// two entities are still touching, only sent when the collision system is asked to (see SetStayEvents())
+class CollisionStayEvent : public CollisionEvent {
+public:
+    static constexpr const char* NAME = "CollisionStayEvent";
+    using CollisionEvent::CollisionEvent;
+};
+
+// two entities stopped touching (either may have been destroyed since)
+class CollisionEndEvent : public CollisionEvent {
+public:
+    static constexpr const char* NAME = "CollisionEndEvent";
+    using CollisionEvent::CollisionEvent;
 };
 
 #endif
@@ -0,0 +1,94 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// collisionlayers.h
+// header file for the collision layers, and the matrix of which layers collide
+// -----------------------------------------------------------------------------
+#ifndef COLLISIONLAYERS_H
+#define COLLISIONLAYERS_H
+
+#include <array>
+#include <cstdint>
+
+enum class CollisionLayer : uint8_t {
+    Default,
+    Player,
+    Enemy,
+    PlayerBullet,
+    EnemyBullet,
+    Static,
+    Count
+};
+
+// the bits of the given layers, e.g. to limit a spatial query to them
+template <typename ...TLayers>
+constexpr uint32_t LayerMask(TLayers... layers) {
+    return ((1u << static_cast<int>(layers)) | ... | 0u);
+}
+
+constexpr uint32_t ALL_LAYERS = ~0u;
+
+// a collider's layer bit, and the bits of the layers it collides with
+struct CollisionFilter {
+    uint32_t layerBit = 1;
+    uint32_t mask = ~0u;
+
+    bool CanCollide(const CollisionFilter& other) const {
+        return (mask & other.layerBit) != 0 && (other.mask & layerBit) != 0;
+    }
+};
+
+// which layers collide with which (symmetric), every layer collides with every layer until told otherwise
+class CollisionLayerMatrix {
+public:
+    CollisionLayerMatrix() {
+        masks.fill((1u << LAYER_COUNT) - 1);
+    }
+
+    void SetCollides(CollisionLayer a, CollisionLayer b, bool collides) {
+        SetBit(a, b, collides);
+        SetBit(b, a, collides);
+    }
+
+    // turns off every pair of a layer, e.g. before listing the few it collides with
+    void ClearLayer(CollisionLayer layer) {
+        for (int other = 0; other < LAYER_COUNT; other++) {
+            SetCollides(layer, static_cast<CollisionLayer>(other), false);
+        }
+    }
+
+    bool Collides(CollisionLayer a, CollisionLayer b) const {
+        return (masks[Index(a)] & Bit(b)) != 0;
+    }
+
+    CollisionFilter GetFilter(CollisionLayer layer) const {
+        return {Bit(layer), masks[Index(layer)]};
+    }
+
+private:
+    static constexpr int LAYER_COUNT = static_cast<int>(CollisionLayer::Count);
+    static_assert(LAYER_COUNT <= 32, "collision layers are bits of a 32 bit mask");
+
+    static int Index(CollisionLayer layer) {return static_cast<int>(layer);}
+    static uint32_t Bit(CollisionLayer layer) {return 1u << Index(layer);}
+
+    void SetBit(CollisionLayer layer, CollisionLayer other, bool collides) {
+        if (collides) {
+            masks[Index(layer)] |= Bit(other);
+        } else {
+            masks[Index(layer)] &= ~Bit(other);
+        }
+    }
+
+    // [Array index = layer]
+    std::array<uint32_t, LAYER_COUNT> masks;
+};
+
+#endif
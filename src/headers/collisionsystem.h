@@ -19,65 +19,305 @@
 #include "collisionevent.h"
 #include "boxcollidercomponent.h"
 #include "transformcomponent.h"
-#include <spdlog/spdlog.h>
+#include "aabb.h"
+#include "broadphase.h"
+#include "collisionlayers.h"
+#include "contactcache.h"
+#include "narrowphase.h"
+#include "logger.h"
+#include "threadpool.h"
+#include <algorithm>
+#include <chrono>
+#include <glm/glm.hpp>
+#include <limits>
+#include <memory>
+#include <span>
+#include <vector>
+
+// a collider a ray went through, fraction is how far along the ray it was entered (0 = origin, 1 = end)
+struct RaycastHit {
+    Entity entity;
+    float fraction;
+    glm::vec2 point;
+};
 
 class CollisionSystem : public System {
 public:
     CollisionSystem() {
         RequireComponent<TransformComponent>();
         RequireComponent<BoxColliderComponent>();
+        ReadsComponent<TransformComponent>();
+
+        // the update rebuilds what the spatial queries read, so it counts as writing the colliders:
+        // the systems that query declare ReadsComponent<BoxColliderComponent>() and never run alongside it
+        WritesComponent<BoxColliderComponent>();
+
+        // the collision events are only queued here, their handlers run when the
+        // event bus is flushed after all the systems are done
+        // (this is the only system queueing collision events)
+    }
+
+    // candidate pairs checked per task
+    static constexpr size_t PAIRS_PER_CHUNK = 1024;
+
+    // picks the broadphase backend, e.g. per level to suit its colliders
+    void SetBroadphase(const BroadphaseSettings& settings) {
+        broadphase = CreateBroadphase(settings);
+    }
+
+    // which collider layers collide, the broadphase never returns the pairs of the others
+    void SetLayerMatrix(const CollisionLayerMatrix& matrix) {
+        layerMatrix = matrix;
+    }
+
+    // also queue a CollisionStayEvent for every contact that goes on, on every frame
+    // (off by default: most handlers only care about the contacts starting/ending)
+    void SetStayEvents(bool enabled) {
+        stayEvents = enabled;
+    }
+
+    // what the broadphase and narrowphase did on the last update
+    const BroadphaseStats& GetBroadphaseStats() const {
+        return stats;
+    }
+
+    // spatial queries, answered by the broadphase from the colliders as of the last Update()
+    // (so the results may hold entities destroyed since): the results go to the caller's buffer
+    // (cleared first, it doesn't allocate once it is big enough), the layer mask limits them to
+    // the colliders of some layers (see LayerMask()), and nothing is changed, so several systems
+    // may query at the same time
+
+    // the colliders overlapping the area, in no particular order
+    void QueryAABB(const AABB& area, std::vector<Entity>& results, uint32_t layerMask = ALL_LAYERS) const {
+        results.clear();
+        broadphase->Query(area, [&](int collider) {
+            if (IsQueryHit(collider, layerMask) && GetColliderBounds(collider).Overlaps(area)) {
+                results.push_back(colliderEntities[collider]);
+            }
+        });
+    }
+
+    // the colliders the point is inside of (not on their edge), in no particular order
+    void QueryPoint(glm::vec2 point, std::vector<Entity>& results, uint32_t layerMask = ALL_LAYERS) const {
+        QueryAABB({point.x, point.y, point.x, point.y}, results, layerMask);
+    }
+
+    // the colliders closer than radius to center, in no particular order
+    void QueryRadius(glm::vec2 center, float radius, std::vector<Entity>& results, uint32_t layerMask = ALL_LAYERS) const {
+        results.clear();
+        const AABB area = {center.x - radius, center.y - radius, center.x + radius, center.y + radius};
+        broadphase->Query(area, [&](int collider) {
+            if (!IsQueryHit(collider, layerMask)) {
+                return;
+            }
+            const AABB bounds = GetColliderBounds(collider);
+            const float dx = center.x - std::clamp(center.x, bounds.minX, bounds.maxX);
+            const float dy = center.y - std::clamp(center.y, bounds.minY, bounds.maxY);
+            if (dx * dx + dy * dy < radius * radius) {
+                results.push_back(colliderEntities[collider]);
+            }
+        });
     }
 
-    void Update(std::unique_ptr<EventBus>& eventBus) {
-        // check all entities to see if colliding with each other
-        auto entities = GetSystemEntities();
+    // the colliders the segment from origin to end goes through, nearest first
+    // (a ray is swept like a continuous collider: a point moving from origin to end)
+    void Raycast(glm::vec2 origin, glm::vec2 end, std::vector<RaycastHit>& hits, uint32_t layerMask = ALL_LAYERS) const {
+        hits.clear();
+        const AABB start = {origin.x, origin.y, origin.x, origin.y};
+        const AABB finish = {end.x, end.y, end.x, end.y};
+        broadphase->Query(start.Union(finish), [&](int collider) {
+            if (!IsQueryHit(collider, layerMask)) {
+                return;
+            }
+            const AABB bounds = GetColliderBounds(collider);
+            float fraction;
+            if (FindTimeOfImpact(start, finish, bounds, bounds, fraction)) {
+                hits.push_back({colliderEntities[collider], fraction, origin + (end - origin) * fraction});
+            }
+        });
+        std::sort(hits.begin(), hits.end(), [](const RaycastHit& a, const RaycastHit& b) {
+            return a.fraction < b.fraction || (a.fraction == b.fraction && a.entity < b.entity);
+        });
+    }
+
+    void Update(std::unique_ptr<EventBus>& eventBus, ThreadPool& threadPool) {
+        auto entities = GetSystemEntitiesSpan();
 
-        // loop all entities that system is interested in
-        for (auto i = entities.begin(); i != entities.end(); i++) {
-            Entity a = *i;
-            auto aTransform = a.GetComponent<TransformComponent>();
-            auto aCollider = a.GetComponent<BoxColliderComponent>();
+        // gather the collider bounds, [Vector index = index in the system entities]
+        // (the entity ids let the broadphase follow the colliders from one frame to the next)
+        // the continuous colliders give the broadphase the bounds swept since their last position
+        bounds.resize(entities.size());
+        startBounds.resize(entities.size());
+        boundsArrays.Resize(entities.size());
+        colliderIds.resize(entities.size());
+        filters.resize(entities.size());
+        continuous.resize(entities.size());
+        colliderEntities.assign(entities.begin(), entities.end());
+        size_t continuousCount = 0;
+        for (size_t i = 0; i < entities.size(); i++) {
+            const auto& collider = entities[i].GetComponent<BoxColliderComponent>();
+            const AABB endBounds = AABB::FromCollider(entities[i].GetComponent<TransformComponent>(), collider);
+            startBounds[i] = GetLastBounds(entities[i], endBounds);
+            bounds[i] = collider.isContinuous ? endBounds.Union(startBounds[i]) : endBounds;
+            boundsArrays.Set(i, endBounds);
+            colliderIds[i] = entities[i].GetId();
+            filters[i] = layerMatrix.GetFilter(collider.layer);
+            continuous[i] = collider.isContinuous;
+            continuousCount += collider.isContinuous;
+        }
 
-            // loop all entities still needing check (to right of i)
-            for (auto j = i; j != entities.end(); j++) {
-                Entity b = *j;
+        // broadphase: only the pairs that may overlap are candidates (sorted like the pairs of a double loop)
+        const auto start = std::chrono::steady_clock::now();
+        broadphase->FindPairs(colliderIds, bounds, filters, candidatePairs, threadPool);
+        stats.name = broadphase->GetName();
+        stats.colliders = entities.size();
+        stats.candidatePairs = candidatePairs.size();
+        stats.findPairsTime = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
 
-                // bypass checking collision with self
-                if (a == b) {
-                    continue;
+        // the pairs with a continuous collider get the swept test below, the others the discrete one
+        sweptPairs.clear();
+        if (continuousCount > 0) {
+            std::erase_if(candidatePairs, [&](const ColliderPair& pair) {
+                if (continuous[pair.a] || continuous[pair.b]) {
+                    sweptPairs.push_back(pair);
+                    return true;
                 }
+                return false;
+            });
+        }
+
+        // narrowphase: the candidates are checked in parallel chunks (a batch of pairs per SIMD compare),
+        // each chunk compacts its overlapping pairs at the start of its own slice of the overlaps
+        // (a pool without workers runs the whole range as a single chunk, the others then stay empty)
+        const size_t chunkCount = (candidatePairs.size() + PAIRS_PER_CHUNK - 1) / PAIRS_PER_CHUNK;
+        overlaps.resize(candidatePairs.size());
+        chunkOverlapCounts.assign(chunkCount, 0);
+        threadPool.ParallelFor(0, candidatePairs.size(), PAIRS_PER_CHUNK, [&](size_t chunkBegin, size_t chunkEnd) {
+            const auto chunk = std::span(candidatePairs).subspan(chunkBegin, chunkEnd - chunkBegin);
+            chunkOverlapCounts[chunkBegin / PAIRS_PER_CHUNK] = FindOverlappingPairs(boundsArrays, chunk, overlaps.data() + chunkBegin);
+        });
+
+        frameContacts.clear();
+        for (size_t chunk = 0; chunk < chunkCount; chunk++) {
+            const ColliderPair* chunkOverlaps = overlaps.data() + chunk * PAIRS_PER_CHUNK;
+            for (size_t i = 0; i < chunkOverlapCounts[chunk]; i++) {
+                frameContacts.emplace_back(entities[chunkOverlaps[i].a], entities[chunkOverlaps[i].b]);
+            }
+        }
+
+        // continuous narrowphase: a continuous collider only touches what it reaches first during the frame
+        // (a bullet that went through a tank and into another one only hits the first), or all of the ones
+        // it reaches at that same time
+        if (!sweptPairs.empty()) {
+            FindSweptContacts(entities);
+        }
 
-                auto bTransform = b.GetComponent<TransformComponent>();
-                auto bCollider = b.GetComponent<BoxColliderComponent>();
-
-                // check for collision between a and b - using AABB
-                bool collisionHappened = CheckAABBCollision(
-                    aTransform.position.x + aCollider.offset.x,
-                    aTransform.position.y + aCollider.offset.y,
-                    aCollider.width,
-                    aCollider.height,
-                    bTransform.position.x + bCollider.offset.x,
-                    bTransform.position.y + bCollider.offset.y,
-                    bCollider.width,
-                    bCollider.height
-                );
-
-                if (collisionHappened) {
-                    spdlog::info("Entity " + std::to_string(a.GetId()) + " is colliding with entity " + std::to_string(b.GetId()));
-                    eventBus->EmitEvent<CollisionEvent>(a, b);
+        // remember where every collider ended, the next frame sweeps the continuous ones from there
+        for (size_t i = 0; i < entities.size(); i++) {
+            SetLastBounds(entities[i], GetColliderBounds(static_cast<int>(i)));
+        }
+        stats.overlappingPairs = frameContacts.size();
+
+        // only the changes since the last frame become events, a contact that goes on is not sent again
+        // (unless the stay events are on)
+        contactCache.Update(frameContacts,
+            [&](const Contact& contact) {
+                LOG_DEBUG_EVERY(LogCategory::Collision, 1000, "Entity {} started colliding with entity {}", contact.a.GetId(), contact.b.GetId());
+                eventBus->Enqueue<CollisionBeginEvent>(contact.a, contact.b);
+            },
+            [&](const Contact& contact) {
+                if (stayEvents) {
+                    eventBus->Enqueue<CollisionStayEvent>(contact.a, contact.b);
                 }
+            },
+            [&](const Contact& contact) {
+                eventBus->Enqueue<CollisionEndEvent>(contact.a, contact.b);
             }
+        );
+    }
+
+private:
+    bool IsQueryHit(int collider, uint32_t layerMask) const {
+        return (filters[collider].layerBit & layerMask) != 0;
+    }
+
+    // where the collider ended the last update (the broadphase may hold its swept or fattened bounds)
+    AABB GetColliderBounds(int collider) const {
+        return {boundsArrays.minX[collider], boundsArrays.minY[collider], boundsArrays.maxX[collider], boundsArrays.maxY[collider]};
+    }
+
+    // where the entity's collider was at the end of the last update, or bounds if it wasn't there
+    // (just added, or another entity with the same id)
+    AABB GetLastBounds(Entity entity, const AABB& bounds) const {
+        const auto id = static_cast<size_t>(entity.GetId());
+        if (id < lastBounds.size() && lastBoundsGenerations[id] == entity.GetGeneration()) {
+            return lastBounds[id];
         }
+        return bounds;
     }
 
-    bool CheckAABBCollision(double aX, double aY, double aW, double aH, double bX, double bY, double bW, double bH) {
-        return (
-            aX < bX + bW &&
-            aX + aW > bX &&
-            aY < bY + bH &&
-            aY + aH > bY
-        );
+    void SetLastBounds(Entity entity, const AABB& bounds) {
+        const auto id = static_cast<size_t>(entity.GetId());
+        if (id >= lastBounds.size()) {
+            lastBounds.resize(id + 1);
+            lastBoundsGenerations.resize(id + 1, -1);
+        }
+        lastBounds[id] = bounds;
+        lastBoundsGenerations[id] = entity.GetGeneration();
+    }
+
+    void FindSweptContacts(std::span<const Entity> entities) {
+        // [Vector index = index in the system entities]
+        earliestImpacts.assign(entities.size(), std::numeric_limits<float>::infinity());
+        sweptImpacts.resize(sweptPairs.size());
+
+        for (size_t i = 0; i < sweptPairs.size(); i++) {
+            const auto [a, b] = sweptPairs[i];
+            float timeOfImpact;
+            if (!FindTimeOfImpact(startBounds[a], GetColliderBounds(a), startBounds[b], GetColliderBounds(b), timeOfImpact)) {
+                timeOfImpact = std::numeric_limits<float>::infinity();
+            }
+            sweptImpacts[i] = timeOfImpact;
+            earliestImpacts[a] = std::min(earliestImpacts[a], timeOfImpact);
+            earliestImpacts[b] = std::min(earliestImpacts[b], timeOfImpact);
+        }
+
+        for (size_t i = 0; i < sweptPairs.size(); i++) {
+            const auto [a, b] = sweptPairs[i];
+            const float timeOfImpact = sweptImpacts[i];
+            if (timeOfImpact == std::numeric_limits<float>::infinity()) {
+                continue;
+            }
+            // first contact of either continuous collider (a discrete one touches all it reaches)
+            if ((continuous[a] && timeOfImpact == earliestImpacts[a]) || (continuous[b] && timeOfImpact == earliestImpacts[b])) {
+                frameContacts.emplace_back(entities[a], entities[b]);
+            }
+        }
     }
+
+    std::unique_ptr<IBroadphase> broadphase = CreateBroadphase({});
+    CollisionLayerMatrix layerMatrix;
+    BroadphaseStats stats;
+    std::vector<AABB> bounds;
+    ColliderBounds boundsArrays;
+    std::vector<int> colliderIds;
+    std::vector<CollisionFilter> filters;
+    std::vector<ColliderPair> candidatePairs;
+    // [Vector index = collider index] the system entities of the last update, for the queries
+    std::vector<Entity> colliderEntities;
+    std::vector<AABB> startBounds;
+    std::vector<bool> continuous;
+    std::vector<ColliderPair> sweptPairs;
+    std::vector<float> sweptImpacts;
+    std::vector<float> earliestImpacts;
+    // [Vector index = entity id]
+    std::vector<AABB> lastBounds;
+    std::vector<int> lastBoundsGenerations;
+    std::vector<ColliderPair> overlaps;
+    std::vector<size_t> chunkOverlapCounts;
+    std::vector<Contact> frameContacts;
+    ContactCache contactCache;
+    bool stayEvents = false;
 };
 
 #endif
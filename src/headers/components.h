@@ -0,0 +1,50 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// components.h
+// registered list of every component type, a type's position in the list is
+// its component id, so new components must be appended at the end to keep the
+// ids of the existing ones stable
+// -----------------------------------------------------------------------------
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "transformcomponent.h"
+#include "rigidbodycomponent.h"
+#include "spritecomponent.h"
+#include "animationcomponent.h"
+#include "boxcollidercomponent.h"
+#include "keyboardcontrolledcomponent.h"
+#include "camerafollowcomponent.h"
+#include "projectileemittercomponent.h"
+#include "healthcomponent.h"
+#include "projectilecomponent.h"
+#include "textlabelcomponent.h"
+
+template <typename ...Ts>
+struct TypeList {
+    static constexpr int size = sizeof...(Ts);
+};
+
+using ComponentTypes = TypeList<
+    TransformComponent,
+    RigidBodyComponent,
+    SpriteComponent,
+    AnimationComponent,
+    BoxColliderComponent,
+    KeyboardControlledComponent,
+    CameraFollowComponent,
+    ProjectileEmitterComponent,
+    HealthComponent,
+    ProjectileComponent,
+    TextLabelComponent
+>;
+
+#endif
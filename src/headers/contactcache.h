@@ -0,0 +1,115 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// contactcache.h
+// header file for the Contact Cache, the pairs of entities that were touching
+// on the last frame (tells the new contacts from the continuing/ended ones)
+// -----------------------------------------------------------------------------
+#ifndef CONTACTCACHE_H
+#define CONTACTCACHE_H
+
+#include "ecs.h"
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// CONTACT
+// two entities touching, the one with the lower id first
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+struct Contact {
+    Entity a;
+    Entity b;
+
+    // both entity ids, the contacts are kept sorted by it
+    uint64_t key;
+
+    Contact(Entity first, Entity second) : a(first), b(second), key(0) {
+        if (b.GetId() < a.GetId()) {
+            std::swap(a, b);
+        }
+        key = (static_cast<uint64_t>(a.GetId()) << 32) | static_cast<uint32_t>(b.GetId());
+    }
+
+    // same key but other generations: one of the entities was destroyed and its id reused
+    bool IsSameEntities(const Contact& other) const {
+        return a == other.a && b == other.b;
+    }
+};
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// CONTACT CACHE
+// the contacts of the last frame, diffed against each new frame's contacts
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+class ContactCache {
+public:
+    // replaces the cached contacts with this frame's ones (in any order, each pair once), calling
+    // onBegin(contact) for the new ones, onStay(contact) for the ones already there and
+    // onEnd(contact) for the ones that are gone, each in key order
+    // (frameContacts gets the old contacts back, so its buffer is reused next frame)
+    template <typename TBegin, typename TStay, typename TEnd>
+    void Update(std::vector<Contact>& frameContacts, TBegin&& onBegin, TStay&& onStay, TEnd&& onEnd) {
+        std::sort(frameContacts.begin(), frameContacts.end(), [](const Contact& x, const Contact& y) { return x.key < y.key; });
+
+        // both lists are sorted by key, a single merge pass finds what changed
+        size_t previous = 0;
+        size_t current = 0;
+        while (previous < contacts.size() && current < frameContacts.size()) {
+            const Contact& oldContact = contacts[previous];
+            const Contact& newContact = frameContacts[current];
+            if (oldContact.key < newContact.key) {
+                onEnd(oldContact);
+                previous++;
+            } else if (newContact.key < oldContact.key) {
+                onBegin(newContact);
+                current++;
+            } else {
+                if (oldContact.IsSameEntities(newContact)) {
+                    onStay(newContact);
+                } else {
+                    onEnd(oldContact);
+                    onBegin(newContact);
+                }
+                previous++;
+                current++;
+            }
+        }
+        for (; previous < contacts.size(); previous++) {
+            onEnd(contacts[previous]);
+        }
+        for (; current < frameContacts.size(); current++) {
+            onBegin(frameContacts[current]);
+        }
+
+        contacts.swap(frameContacts);
+        frameContacts.clear();
+    }
+
+    // the contacts of the last Update(), sorted by key
+    const std::vector<Contact>& GetContacts() const {
+        return contacts;
+    }
+
+    // forgets every contact (without ending them), e.g. when the level is unloaded
+    void Clear() {
+        contacts.clear();
+    }
+
+private:
+    std::vector<Contact> contacts;
+};
+
+#endif
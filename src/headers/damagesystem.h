@@ -20,7 +20,8 @@
 #include "healthcomponent.h"
 #include "eventbus.h"
 #include "collisionevent.h"
-#include <spdlog/spdlog.h>
+#include "logger.h"
+#include <span>
 
 class DamageSystem : public System {
 public:
@@ -29,27 +30,46 @@ public:
     }
 
     void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
-        eventBus->SubscribeToEvent<CollisionEvent>(this, &DamageSystem::onCollision);
+        // only the collisions involving a projectile can deal damage, once when they start touching
+        eventBus->SubscribeToEventBatch<CollisionBeginEvent>(this, &DamageSystem::OnCollisions, EventFilter::WithComponents<ProjectileComponent>());
     }
 
-    void onCollision(CollisionEvent& event) {
+    // all the contacts that started this frame, queued by the collision system
+    void OnCollisions(std::span<const CollisionBeginEvent> events) {
+        for (const auto& event : events) {
+            OnCollision(event);
+        }
+    }
+
+    void OnCollision(const CollisionEvent& event) {
         Entity a = event.a;
         Entity b = event.b;
-        spdlog::info("The Damage System received an event collision between entities " + std::to_string(a.GetId()) + " and " + std::to_string(b.GetId()));
+
+        // ignore events about entities that were destroyed since the event was raised
+        if (!a.IsAlive() || !b.IsAlive()) {
+            return;
+        }
+
+        LOG_DEBUG_EVERY(LogCategory::Damage, 1000, "The Damage System received an event collision between entities {} and {}", a.GetId(), b.GetId());
         
+        // the collider layers tell the projectiles and their targets apart (the layer matrix
+        // already dropped the pairs that can't hurt, like bullets of the same side)
+        const CollisionLayer layerA = a.GetComponent<BoxColliderComponent>().layer;
+        const CollisionLayer layerB = b.GetComponent<BoxColliderComponent>().layer;
+
         // if enemy projectile hits player / player hits projectile
-        if (a.BelongsToGroup("projectiles") && b.HasTag("player")) {
+        if (layerA == CollisionLayer::EnemyBullet && layerB == CollisionLayer::Player) {
             OnProjectileHitsPlayer(a, b); // a is projectile, b is player
         }
-        if (b.BelongsToGroup("projectiles") && a.HasTag("player")) {
+        if (layerB == CollisionLayer::EnemyBullet && layerA == CollisionLayer::Player) {
             OnProjectileHitsPlayer(b, a); // b is projectile, a is player
         }
 
         // if friendly projectile hits enemy / enemy hits projectile
-        if (a.BelongsToGroup("projectiles") && b.BelongsToGroup("enemies")) {
+        if (layerA == CollisionLayer::PlayerBullet && layerB == CollisionLayer::Enemy) {
             OnProjectileHitsEnemy(a, b); // a is projectile, b is enemy
         }
-        if (b.BelongsToGroup("projectiles") && a.BelongsToGroup("enemies")) {
+        if (layerB == CollisionLayer::PlayerBullet && layerA == CollisionLayer::Enemy) {
             OnProjectileHitsEnemy(b, a); // b is projectile, a is enemy
         }
     }
@@ -0,0 +1,102 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// dynamicaabbtree.h
+// header file for the dynamic bounding volume tree (a balanced binary tree of
+// AABBs, leaves hold fattened bounds so small moves don't touch the tree)
+// -----------------------------------------------------------------------------
+#ifndef DYNAMICAABBTREE_H
+#define DYNAMICAABBTREE_H
+
+#include "aabb.h"
+#include <vector>
+
+class DynamicAABBTree {
+public:
+    static constexpr int NULL_NODE = -1;
+
+    explicit DynamicAABBTree(float margin = 8.0f): margin(margin) {}
+
+    // adds a leaf for bounds (stored fattened by the margin), returns its proxy id
+    int CreateProxy(const AABB& bounds, int userData);
+    void DestroyProxy(int proxyId);
+
+    // updates the bounds of a leaf, returns true when it had to be reinserted
+    // (the bounds left its fattened bounds)
+    bool MoveProxy(int proxyId, const AABB& bounds);
+
+    int GetUserData(int proxyId) const {return nodes[proxyId].userData;}
+    void SetUserData(int proxyId, int userData) {nodes[proxyId].userData = userData;}
+    const AABB& GetFatAABB(int proxyId) const {return nodes[proxyId].bounds;}
+
+    void Clear();
+
+    // calls func(proxyId) for every leaf whose fattened bounds overlap bounds, until func returns false
+    template <typename TFunc>
+    void Query(const AABB& bounds, TFunc&& func) const {
+        if (root == NULL_NODE) {
+            return;
+        }
+
+        // walks the tree with a fixed stack, a balanced tree of a million leaves is about 40 deep
+        int stack[QUERY_STACK_SIZE];
+        int stackSize = 0;
+        stack[stackSize++] = root;
+        while (stackSize > 0) {
+            const Node& node = nodes[stack[--stackSize]];
+            if (!node.bounds.Overlaps(bounds)) {
+                continue;
+            }
+            if (node.IsLeaf()) {
+                if (!func(static_cast<int>(&node - nodes.data()))) {
+                    return;
+                }
+            } else if (stackSize + 2 <= QUERY_STACK_SIZE) {
+                stack[stackSize++] = node.child1;
+                stack[stackSize++] = node.child2;
+            }
+        }
+    }
+
+    int GetHeight() const {return root == NULL_NODE ? 0 : nodes[root].height;}
+
+private:
+    static constexpr int QUERY_STACK_SIZE = 256;
+
+    struct Node {
+        AABB bounds;
+        int parent;         // next free node while the node is in the free list
+        int child1;
+        int child2;
+        int height;         // leaves are 0, free nodes -1
+        int userData;
+
+        bool IsLeaf() const {return child1 == NULL_NODE;}
+    };
+
+    int AllocateNode();
+    void FreeNode(int nodeId);
+
+    void InsertLeaf(int leaf);
+    void RemoveLeaf(int leaf);
+
+    // rotates the subtree at nodeId if its children heights differ by more than one, returns its new root
+    int Balance(int nodeId);
+
+    // refits the bounds and heights from a node up to the root, balancing on the way
+    void Refit(int nodeId);
+
+    std::vector<Node> nodes;
+    int root = NULL_NODE;
+    int freeList = NULL_NODE;
+    float margin;
+};
+
+#endif
@@ -14,61 +14,200 @@
 #ifndef ECS_H
 #define ECS_H
 
-#include <iostream>
+#include <cstddef>
+#include <new>
 #include <vector>
-#include <bitset>
+#include <span>
+#include <type_traits>
+#include <tuple>
+#include <cstdint>
+#include <bit>
 #include <set>
-#include <deque>
+#include <cassert>
+#include <memory>
+#include <algorithm>
 #include <unordered_map>
 #include <typeindex>
-#include <spdlog/spdlog.h>
+#include <mutex>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+#include "components.h"
+#include "logger.h"
+#include "threadpool.h"
 
 
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
-// SIGNATURE
-// bitset, tracks components in an entity, entities system will target
+// COMPONENT
+// holds data of an entity, to be manipulated by systems
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
-const unsigned int MAX_COMPONENTS = 32;
-typedef std::bitset<MAX_COMPONENTS> Signature;
+// position of T in a TypeList, or -1 when it isn't listed
+template <typename T, typename TList>
+struct TypeIndex;
+
+template <typename T, typename ...Ts>
+struct TypeIndex<T, TypeList<Ts...>> {
+    static constexpr int value = [] {
+        int index = 0;
+        const bool found = ((std::is_same_v<T, Ts> ? true : (index++, false)) || ...);
+        return found ? index : -1;
+    }();
+};
+
+// Used to assign a unique id to a component type, the id is the type's position in
+// the registered ComponentTypes list (see components.h), so it is the same on every run
+template <typename T>
+class Component {
+public:
+    static constexpr int ID = TypeIndex<std::remove_cv_t<T>, ComponentTypes>::value;
+    static_assert(ID != -1, "component type is not registered in ComponentTypes (components.h)");
+
+    // Returns the unique id of Component<T>
+    static constexpr int GetId() {return ID;}
+};
 
 
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
-// COMPONENT
-// holds data of an entity, to be manipulated by systems
+// SIGNATURE
+// bitset, tracks components in an entity, entities system will target
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
-struct IComponent {
-protected:
-    static int nextId;
-};
+// signatures are sized to the registered component count, rounded to 64/128/256/... bits
+const unsigned int SIGNATURE_WORDS = std::bit_ceil(static_cast<unsigned int>((ComponentTypes::size + 63) / 64));
+const unsigned int MAX_COMPONENTS = SIGNATURE_WORDS * 64;
 
-// Used to assign a unique id to a component type
-template <typename T>
-class Component: public IComponent {
+class Signature {
 public:
-    // Returns the unique id of Component<T>
-    static int GetId() {
-        static auto id = nextId++;
-        return id;
+    Signature& Set(size_t bit) {
+        words[bit / 64] |= uint64_t(1) << (bit % 64);
+        return *this;
+    }
+
+    Signature& Reset(size_t bit) {
+        words[bit / 64] &= ~(uint64_t(1) << (bit % 64));
+        return *this;
+    }
+
+    // clears every bit
+    Signature& Reset() {
+        *this = Signature();
+        return *this;
+    }
+
+    bool Test(size_t bit) const {
+        return (words[bit / 64] >> (bit % 64)) & 1;
+    }
+
+    bool None() const {
+        uint64_t any = 0;
+        for (unsigned int i = 0; i < SIGNATURE_WORDS; i++) {
+            any |= words[i];
+        }
+        return any == 0;
+    }
+
+    // true when every bit of required is also set here (an entity matching a system)
+    bool Includes(const Signature& required) const {
+#if defined(__AVX2__)
+        if constexpr (SIGNATURE_WORDS % 4 == 0) {
+            for (unsigned int i = 0; i < SIGNATURE_WORDS; i += 4) {
+                const __m256i have = _mm256_load_si256(reinterpret_cast<const __m256i*>(words + i));
+                const __m256i need = _mm256_load_si256(reinterpret_cast<const __m256i*>(required.words + i));
+                const __m256i missing = _mm256_andnot_si256(have, need);
+                if (!_mm256_testz_si256(missing, missing)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+#endif
+#if defined(__SSE2__)
+        if constexpr (SIGNATURE_WORDS % 2 == 0) {
+            for (unsigned int i = 0; i < SIGNATURE_WORDS; i += 2) {
+                const __m128i have = _mm_load_si128(reinterpret_cast<const __m128i*>(words + i));
+                const __m128i need = _mm_load_si128(reinterpret_cast<const __m128i*>(required.words + i));
+                const __m128i missing = _mm_andnot_si128(have, need);
+                if (_mm_movemask_epi8(_mm_cmpeq_epi8(missing, _mm_setzero_si128())) != 0xFFFF) {
+                    return false;
+                }
+            }
+            return true;
+        }
+#endif
+        uint64_t missing = 0;
+        for (unsigned int i = 0; i < SIGNATURE_WORDS; i++) {
+            missing |= required.words[i] & ~words[i];
+        }
+        return missing == 0;
+    }
+
+    // calls func(componentId) for every set bit, lowest id first
+    template <typename TFunc>
+    void ForEachSetBit(TFunc func) const {
+        for (unsigned int i = 0; i < SIGNATURE_WORDS; i++) {
+            uint64_t bits = words[i];
+            while (bits) {
+                func(static_cast<int>(i * 64 + std::countr_zero(bits)));
+                bits &= bits - 1;
+            }
+        }
+    }
+
+    size_t Hash() const {
+        size_t hash = 0;
+        for (unsigned int i = 0; i < SIGNATURE_WORDS; i++) {
+            hash ^= std::hash<uint64_t>()(words[i]) + 0x9e3779b97f4a7c15 + (hash << 6) + (hash >> 2);
+        }
+        return hash;
+    }
+
+    Signature operator |(const Signature& other) const {
+        Signature result;
+        for (unsigned int i = 0; i < SIGNATURE_WORDS; i++) {
+            result.words[i] = words[i] | other.words[i];
+        }
+        return result;
+    }
+
+    Signature operator &(const Signature& other) const {
+        Signature result;
+        for (unsigned int i = 0; i < SIGNATURE_WORDS; i++) {
+            result.words[i] = words[i] & other.words[i];
+        }
+        return result;
     }
+
+    bool operator ==(const Signature& other) const = default;
+
+private:
+    alignas(32) uint64_t words[SIGNATURE_WORDS] = {};
+};
+
+template <>
+struct std::hash<Signature> {
+    size_t operator()(const Signature& signature) const {return signature.Hash();}
 };
 
 
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
 // ENTITY
-// id to keep track of numerous entity instances
+// id (slot index) plus generation, to keep track of numerous entity instances
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
 class Entity {
 public:
-    Entity(int id): id(id) {};
+    explicit Entity(int id, int generation = 0): id(id), generation(generation) {};
     Entity(const Entity& entity) = default;
     void Kill();
+    bool IsAlive() const;
     int GetId() const;
+    int GetGeneration() const;
 
     // manage entity tags and groups
     void Tag(const std::string& tag);
@@ -78,22 +217,25 @@ public:
  
     // operator overloading for entity objects
     Entity& operator =(const Entity& other) = default;
-    bool operator ==(const Entity& other) const { return id == other.id; }
-    bool operator !=(const Entity& other) const { return id != other.id; }
-    bool operator >(const Entity& other) const { return id > other.id; }
-    bool operator <(const Entity& other) const { return id < other.id; }
+    // a stale handle (older generation) never compares equal to the entity now using its id
+    bool operator ==(const Entity& other) const { return id == other.id && generation == other.generation; }
+    bool operator !=(const Entity& other) const { return !(*this == other); }
+    bool operator >(const Entity& other) const { return other < *this; }
+    bool operator <(const Entity& other) const { return id < other.id || (id == other.id && generation < other.generation); }
 
     // manage entity components
     template <typename TComponent, typename ...TArgs> void AddComponent(TArgs&& ...args);
     template <typename TComponent> void RemoveComponent();
     template <typename TComponent> bool HasComponent() const;
     template <typename TComponent> TComponent& GetComponent() const;
+    template <typename TComponent> TComponent* TryGetComponent() const;
 
     // hold a pointer to the entity's owner registry
     class Registry* registry;
 
 private:
     int id;
+    int generation;
 };
 
 
@@ -109,112 +251,550 @@ public:
     ~System() = default;
         
     void AddEntityToSystem(Entity entity);
+    void AddEntitiesToSystem(std::span<const Entity> newEntities);
     void RemoveEntityFromSystem(Entity entity);
+    bool HasEntity(Entity entity) const;
     std::vector<Entity> GetSystemEntities() const;
+    std::span<const Entity> GetSystemEntitiesSpan() const;
     const Signature& GetComponentSignature() const;
 
     // Defines the component type that entities must have to be considered by the system
     template <typename TComponent> void RequireComponent();
 
+    // Declares how the system's Update() accesses component data, the scheduler runs
+    // systems whose accesses don't conflict at the same time (see SystemScheduler)
+    template <typename TComponent> void ReadsComponent();
+    template <typename TComponent> void WritesComponent();
+
+    // Declares that the system can't run alongside any other one: it creates entities,
+    // adds/removes components, or emits events whose handlers do (kills are fine)
+    void RequireExclusiveAccess();
+
+    const Signature& GetReadSignature() const;
+    const Signature& GetWriteSignature() const;
+    bool IsExclusive() const;
+
 private:
     Signature componentSignature;
+
+    // declared component accesses of the system Update()
+    Signature readSignature;
+    Signature writeSignature;
+    bool isExclusive = false;
+
+    // packed member entities, plus each member's index in it for O(1) swap-removal
+    // [entityIndices index = entity id, value = index in entities or -1]
     std::vector<Entity> entities;
+    std::vector<int> entityIndices;
+};
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// MEMORY ARENA
+// registry-owned memory the component storage carves its chunks from
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+class MemoryArena {
+public:
+    static constexpr size_t BLOCK_BYTES = 1024 * 1024;
+    static constexpr size_t ALIGNMENT = 64;
+
+    MemoryArena() = default;
+    ~MemoryArena();
+    MemoryArena(const MemoryArena&) = delete;
+    MemoryArena& operator =(const MemoryArena&) = delete;
+
+    // returns 64-byte aligned memory, reusing a freed allocation of the same size when there is one
+    void* Allocate(size_t bytes);
+
+    // hands memory back for reuse (it is only released to the system with the arena)
+    void Free(void* memory, size_t bytes);
+
+    // makes sure the next allocations totalling bytes won't need a new block
+    void Reserve(size_t bytes);
+
+    size_t GetBytesReserved() const {return bytesReserved;}
+    size_t GetBytesAllocated() const {return bytesAllocated;}
+
+private:
+    static size_t RoundUp(size_t bytes) {return (bytes + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;}
+
+    void AddBlock(size_t bytes);
+
+    // memory is bumped from the last block, older blocks are full
+    struct Block {
+        std::byte* memory;
+        size_t size;
+    };
+    std::vector<Block> blocks;
+    size_t blockUsed = 0;
+
+    // freed allocations waiting to be reused [Map key = allocation size]
+    std::unordered_map<size_t, std::vector<void*>> freeLists;
+
+    size_t bytesReserved = 0;
+    size_t bytesAllocated = 0;
 };
 
 
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
 // POOL
-// vector (contiguous data) of objects of type T
+// sparse set of objects of type T, packed (contiguous) and indexed by entity id
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
+// allocation counters of the storage of one component type (all in bytes, except growEvents)
+struct PoolStats {
+    size_t bytesReserved = 0;
+    size_t bytesUsed = 0;
+    size_t growEvents = 0;
+    size_t highWaterMark = 0;
+};
+
 class IPool {
 public:
     virtual ~IPool() = default;
     virtual void RemoveEntityFromPool(int entityId) = 0;
+    virtual PoolStats GetStats() const = 0;
 };
 
+// the packed objects live in fixed-size chunks instead of one growing vector, so growing
+// the pool never moves existing objects (only Remove moves the last object into the hole)
 template <typename T>
 class Pool: public IPool {
 public:
-    Pool(int capacity = 100) {
-        size = 0;
-        data.resize(capacity);
+    static constexpr size_t CHUNK_BYTES = 16 * 1024;
+    static constexpr int CHUNK_CAPACITY = static_cast<int>(std::bit_floor(std::max<size_t>(1, CHUNK_BYTES / sizeof(T))));
+
+    // without an arena the chunks come straight from operator new
+    explicit Pool(MemoryArena* arena = nullptr, int capacity = 0): arena(arena) {
+        Reserve(capacity);
+    }
+
+    virtual ~Pool() {
+        Clear();
+        for (auto chunk : chunks) {
+            FreeChunk(chunk);
+        }
     }
 
-    virtual ~Pool() = default;
+    Pool(const Pool&) = delete;
+    Pool& operator =(const Pool&) = delete;
 
     bool IsEmpty() const {return size == 0;}
 
     int GetSize() const {return size;}
 
-    void Resize(int n) {data.resize(n);}
+    int GetCapacity() const {return static_cast<int>(chunks.size()) * CHUNK_CAPACITY;}
 
+    // allocates chunks up front, these don't count as grow events
+    void Reserve(int n) {
+        while (GetCapacity() < n) {
+            chunks.push_back(AllocateChunk());
+        }
+        denseEntityIds.reserve(n);
+    }
+
+    // destroys every object but keeps the chunks for reuse
     void Clear() {
-        data.clear();
+        for (int i = 0; i < size; i++) {
+            At(i).~T();
+        }
         size = 0;
+        denseEntityIds.clear();
+        sparsePages.clear();
     }
 
-    void Add(T object) {data.push_back(object);}
+    bool Contains(int entityId) const {
+        const auto page = static_cast<size_t>(entityId) >> PAGE_BITS;
+        return page < sparsePages.size() && sparsePages[page] && sparsePages[page][entityId & PAGE_MASK] != INVALID_INDEX;
+    }
 
     void Set(int entityId, T object) {
-        if (entityIdToIndex.find(entityId) != entityIdToIndex.end()) {
+        if (Contains(entityId)) {
             // if the element exists, replace the component object
-            int index = entityIdToIndex[entityId];
-            data[index] = object;
+            At(SparseIndex(entityId)) = std::move(object);
         }
         else {
-            // when adding new object, keep track of entity ids and vec indexes
-            int index = size;
-            entityIdToIndex.emplace(entityId, index);
-            indexToEntityId.emplace(index, entityId);
-            if (index >= data.capacity()) {
-                // resize by always doubling the current capacity
-                data.resize(size * 2);
-            }
-            data[index] = object;
-            size++;
+            // when adding new object, append it to the packed arrays and point the sparse slot at it
+            new (Append(entityId)) T(std::move(object));
         }
     }
 
+    template <typename ...TArgs>
+    T& Emplace(int entityId, TArgs&& ...args) {
+        if (Contains(entityId)) {
+            T& object = At(SparseIndex(entityId));
+            object = T(std::forward<TArgs>(args)...);
+            return object;
+        }
+        return *new (Append(entityId)) T(std::forward<TArgs>(args)...);
+    }
+
     void Remove(int entityId) {
-        // copy the last element to the deleted position to keep array packed
-        int indexOfRemoved = entityIdToIndex[entityId];
-        int indexOfLast = size - 1;
-        data[indexOfRemoved] = data[indexOfLast];
+        assert(Contains(entityId) && "Remove of a component the entity doesn't have");
 
-        // update the index-entity maps to point to the correct elements
-        int entityIdOfLastElement = indexToEntityId[indexOfLast];
-        entityIdToIndex[entityIdOfLastElement] = indexOfRemoved;
-        indexToEntityId[indexOfRemoved] = entityIdOfLastElement;
+        // move the last element to the deleted position to keep array packed
+        int& indexOfRemoved = SparseIndex(entityId);
+        const int indexOfLast = size - 1;
+        const int entityIdOfLastElement = denseEntityIds[indexOfLast];
 
-        entityIdToIndex.erase(entityId);
-        indexToEntityId.erase(indexOfLast);
+        if (indexOfRemoved != indexOfLast) {
+            At(indexOfRemoved) = std::move(At(indexOfLast));
+            denseEntityIds[indexOfRemoved] = entityIdOfLastElement;
+            SparseIndex(entityIdOfLastElement) = indexOfRemoved;
+        }
 
+        indexOfRemoved = INVALID_INDEX;
+        At(indexOfLast).~T();
         size--;
+        denseEntityIds.pop_back();
     }
 
     void RemoveEntityFromPool(int entityId) override {
-        if (entityIdToIndex.find(entityId) != entityIdToIndex.end()) {
+        if (Contains(entityId)) {
             Remove(entityId);
         }
     }
 
+    PoolStats GetStats() const override {
+        PoolStats stats;
+        stats.bytesReserved = static_cast<size_t>(GetCapacity()) * sizeof(T);
+        stats.bytesUsed = static_cast<size_t>(size) * sizeof(T);
+        stats.growEvents = growEvents;
+        stats.highWaterMark = static_cast<size_t>(highWaterMark) * sizeof(T);
+        return stats;
+    }
+
     T& Get(int entityId) {
-        int index = entityIdToIndex[entityId];
-        return static_cast<T&>(data[index]);
+        return At(SparseIndex(entityId));
     }
 
-    T& operator [](unsigned int index) {return data[index];}
+    // packed entity id of the object stored at a given index
+    int GetEntityId(unsigned int index) const {return denseEntityIds[index];}
+    std::span<const int> GetEntityIds() const {return denseEntityIds;}
+
+    T& operator [](unsigned int index) {return At(index);}
 
 private:
-    // keep track of the vector of objects and current num of elements
-    std::vector<T> data;
-    int size;
+    // the sparse array is split into pages so huge entity ids don't allocate one huge array
+    static constexpr int PAGE_BITS = 10;
+    static constexpr int PAGE_SIZE = 1 << PAGE_BITS;
+    static constexpr int PAGE_MASK = PAGE_SIZE - 1;
+    static constexpr int INVALID_INDEX = -1;
+
+    static constexpr int CHUNK_SHIFT = std::countr_zero(static_cast<unsigned int>(CHUNK_CAPACITY));
+    static constexpr int CHUNK_MASK = CHUNK_CAPACITY - 1;
+    static constexpr size_t CHUNK_ALLOCATION_BYTES = sizeof(T) * CHUNK_CAPACITY;
+
+    T& At(int index) {
+        return chunks[index >> CHUNK_SHIFT][index & CHUNK_MASK];
+    }
+
+    // claims the next packed slot for an entity and returns its (unconstructed) memory
+    T* Append(int entityId) {
+        if (size == GetCapacity()) {
+            chunks.push_back(AllocateChunk());
+            growEvents++;
+        }
+        EnsurePage(entityId)[entityId & PAGE_MASK] = size;
+        denseEntityIds.push_back(entityId);
+        T* slot = &At(size++);
+        highWaterMark = std::max(highWaterMark, size);
+        return slot;
+    }
+
+    T* AllocateChunk() {
+        static_assert(alignof(T) <= MemoryArena::ALIGNMENT, "component alignment is above the arena alignment");
+        if (arena) {
+            return static_cast<T*>(arena->Allocate(CHUNK_ALLOCATION_BYTES));
+        }
+        return static_cast<T*>(::operator new(CHUNK_ALLOCATION_BYTES, std::align_val_t(MemoryArena::ALIGNMENT)));
+    }
+
+    void FreeChunk(T* chunk) {
+        if (arena) {
+            arena->Free(chunk, CHUNK_ALLOCATION_BYTES);
+        }
+        else {
+            ::operator delete(chunk, std::align_val_t(MemoryArena::ALIGNMENT));
+        }
+    }
+
+    int& SparseIndex(int entityId) {
+        return sparsePages[static_cast<size_t>(entityId) >> PAGE_BITS][entityId & PAGE_MASK];
+    }
+
+    int* EnsurePage(int entityId) {
+        const auto page = static_cast<size_t>(entityId) >> PAGE_BITS;
+        if (page >= sparsePages.size()) {
+            sparsePages.resize(page + 1);
+        }
+        if (!sparsePages[page]) {
+            sparsePages[page] = std::make_unique<int[]>(PAGE_SIZE);
+            std::fill_n(sparsePages[page].get(), PAGE_SIZE, INVALID_INDEX);
+        }
+        return sparsePages[page].get();
+    }
+
+    MemoryArena* arena;
+
+    // keep track of the packed (chunked) objects, and which entity owns each of them
+    std::vector<T*> chunks;
+    int size = 0;
+    std::vector<int> denseEntityIds;
+
+    // paged sparse array: [entity id] -> index into the packed arrays (or INVALID_INDEX)
+    std::vector<std::unique_ptr<int[]>> sparsePages;
+
+    // allocation counters, see PoolStats
+    size_t growEvents = 0;
+    int highWaterMark = 0;
+};
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// POOL STORAGE
+// component storage backend with one sparse set pool per component type
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+class PoolStorage {
+public:
+    explicit PoolStorage(MemoryArena& arena): arena(&arena) {}
+
+    template <typename TComponent, typename ...TArgs> TComponent& Emplace(int entityId, const Signature& signature, TArgs&& ...args);
+    template <typename ...TComponents, typename ...TInitializers> void EmplaceBulk(std::span<const Entity> entities, TInitializers&& ...initializers);
+    template <typename TComponent> void Remove(int entityId, const Signature& signature);
+    template <typename TComponent> TComponent& Get(int entityId) const;
+    template <typename TComponent> int Count() const;
+
+    // pre-sizes the pool of a component type, and reports its allocation counters
+    template <typename TComponent> void Reserve(int capacity);
+    template <typename TComponent> PoolStats GetStats() const;
+
+    // remove every component of an entity (signature says which pools hold one)
+    void RemoveEntity(int entityId, const Signature& signature);
+
+    // calls func(Entity, TComponents&...) for each entity owning all the components
+    template <typename ...TComponents, typename TFunc> void Each(class Registry* registry, TFunc&& func) const;
+
+    // same as Each, but splits the entities into chunks run in parallel on the thread pool
+    template <typename ...TComponents, typename TFunc> void ParallelEach(class Registry* registry, ThreadPool& threadPool, TFunc&& func) const;
+
+private:
+    // entities handed to one parallel task
+    static constexpr size_t PARALLEL_GRAIN_SIZE = 1024;
+
+    // shared by Each/ParallelEach, runRanges(count, grainSize, body) decides how body(begin, end) covers the entities
+    template <typename ...TComponents, typename TRunRanges, typename TFunc> void EachInRanges(class Registry* registry, TRunRanges&& runRanges, TFunc&& func) const;
+
+    // returns the pool of a component type, or nullptr if none was ever added
+    template <typename TComponent> Pool<TComponent>* GetPool() const;
+    template <typename TComponent> Pool<TComponent>* GetOrCreatePool();
+
+    MemoryArena* arena;
+
+    // vector of component pools, each pool contains all the data for a certain compoenent type
+    // [Vector index = component type id]
+    // [Pool index = entity id]
+    std::vector<std::shared_ptr<IPool>> componentPools;
+};
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// ARCHETYPE
+// all entities with the same signature, stored in fixed-size chunks of SoA columns
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// type-erased operations needed to move components between archetypes
+struct ComponentTypeInfo {
+    size_t size = 0;
+    size_t alignment = 0;
+    void (*moveConstruct)(void* destination, void* source) = nullptr;
+    void (*destroy)(void* object) = nullptr;
+};
+
+class Archetype {
+public:
+    static constexpr size_t CHUNK_BYTES = 16 * 1024;
+
+    Archetype(const Signature& signature, const std::vector<ComponentTypeInfo>& typeInfos, MemoryArena& arena);
+    ~Archetype();
+    Archetype(const Archetype&) = delete;
+    Archetype& operator =(const Archetype&) = delete;
+
+    const Signature& GetSignature() const {return signature;}
+    int GetSize() const {return size;}
+    int GetChunkCount() const {return static_cast<int>(chunks.size());}
+    int GetChunkCapacity() const {return chunkCapacity;}
+
+    // chunks allocated because the archetype was full, and the most rows it ever held
+    size_t GetGrowEvents() const {return growEvents;}
+    int GetHighWaterMark() const {return highWaterMark;}
+
+    // number of used rows in a chunk (only the last chunk can be partially filled)
+    int GetChunkSize(int chunk) const {return std::min(chunkCapacity, size - chunk * chunkCapacity);}
+
+    bool HasColumn(int componentId) const {return signature.Test(componentId);}
 
-    // helper maps to keep track of entity ids per index, so vector stays packed
-    std::unordered_map<int, int> entityIdToIndex;
-    std::unordered_map<int, int> indexToEntityId;
+    // packed arrays of one chunk: entity ids, and the column of a component type
+    const int* GetEntityIds(int chunk) const {return reinterpret_cast<const int*>(chunks[chunk]);}
+    void* GetColumn(int chunk, int componentId) const {return chunks[chunk] + columns[columnOfComponent[componentId]].offset;}
+
+    // address of one component of the entity stored at a row
+    void* GetComponent(int row, int componentId) const {
+        const Column& column = columns[columnOfComponent[componentId]];
+        return chunks[row / chunkCapacity] + column.offset + (row % chunkCapacity) * column.info.size;
+    }
+
+    // appends an (uninitialized) row for an entity and returns it
+    int AllocateRow(int entityId);
+
+    // allocates enough chunks up front to hold a number of rows
+    void Reserve(int rows);
+
+    // destroys the components of a row and moves the last row into it
+    // returns the id of the entity that moved into the row, or -1 if none did
+    int RemoveRow(int row);
+
+    // cached archetype graph edges: archetype reached by adding/removing a component
+    std::vector<Archetype*> addEdges;
+    std::vector<Archetype*> removeEdges;
+
+private:
+    struct Column {
+        int componentId;
+        size_t offset;
+        ComponentTypeInfo info;
+    };
+
+    std::byte* AllocateChunk();
+    void FreeChunk(std::byte* chunk);
+
+    Signature signature;
+    std::vector<Column> columns;
+    std::vector<int> columnOfComponent;
+    MemoryArena* arena;
+    std::vector<std::byte*> chunks;
+    int chunkCapacity = 0;
+    size_t chunkBytes = CHUNK_BYTES;
+    int size = 0;
+    size_t growEvents = 0;
+    int highWaterMark = 0;
+};
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// ARCHETYPE STORAGE
+// component storage backend that groups entities by signature (see Archetype)
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+class ArchetypeStorage {
+public:
+    explicit ArchetypeStorage(MemoryArena& arena): arena(&arena) {}
+    ArchetypeStorage(const ArchetypeStorage&) = delete;
+    ArchetypeStorage& operator =(const ArchetypeStorage&) = delete;
+
+    template <typename TComponent, typename ...TArgs> TComponent& Emplace(int entityId, const Signature& signature, TArgs&& ...args);
+    template <typename ...TComponents, typename ...TInitializers> void EmplaceBulk(std::span<const Entity> entities, TInitializers&& ...initializers);
+    template <typename TComponent> void Remove(int entityId, const Signature& signature);
+    template <typename TComponent> TComponent& Get(int entityId) const;
+    template <typename TComponent> int Count() const;
+
+    // archetypes hold many component types per chunk, so reserving for one type only adds to
+    // what the arena is grown by (once, for all the types reserved, before the next component
+    // is added); the stats add up the column of that type in every archetype that has it
+    template <typename TComponent> void Reserve(int capacity);
+    template <typename TComponent> PoolStats GetStats() const;
+
+    // remove every component of an entity (drops it from its archetype)
+    void RemoveEntity(int entityId, const Signature& signature);
+
+    // calls func(Entity, TComponents&...) for each entity owning all the components,
+    // walking the matching archetypes chunk by chunk
+    template <typename ...TComponents, typename TFunc> void Each(class Registry* registry, TFunc&& func) const;
+
+    // same as Each, but the chunks of each matching archetype run in parallel on the thread pool
+    template <typename ...TComponents, typename TFunc> void ParallelEach(class Registry* registry, ThreadPool& threadPool, TFunc&& func) const;
+
+private:
+    // where an entity's components currently live
+    struct EntityLocation {
+        Archetype* archetype = nullptr;
+        int row = -1;
+    };
+
+    template <typename TComponent> void RegisterComponentType();
+    Archetype* GetArchetype(const Signature& signature);
+    Archetype* GetAddTarget(Archetype* source, int componentId);
+    Archetype* GetRemoveTarget(Archetype* source, int componentId);
+
+    // moves an entity's shared components to another archetype (target may be nullptr = no components)
+    void MoveEntity(int entityId, Archetype* target);
+
+    EntityLocation& GetLocation(int entityId);
+
+    // grows the arena by the bytes the Reserve() calls since the last component add asked for
+    void ReservePending();
+
+    // shared by Each/ParallelEach, runRanges(count, grainSize, body) decides how body(begin, end) covers the chunks
+    template <typename ...TComponents, typename TRunRanges, typename TFunc> void EachInRanges(class Registry* registry, TRunRanges&& runRanges, TFunc&& func) const;
+
+    MemoryArena* arena;
+
+    // [Vector index = component type id]
+    std::vector<ComponentTypeInfo> componentTypeInfos;
+
+    // [Map key = archetype signature]
+    std::unordered_map<Signature, std::unique_ptr<Archetype>> archetypes;
+    std::vector<Archetype*> archetypeList;
+
+    // [Vector index = entity id]
+    std::vector<EntityLocation> entityLocations;
+
+    // reserved but not yet taken from the arena: the columns, the most rows of any one type, and the types
+    size_t pendingReserveBytes = 0;
+    int pendingReserveRows = 0;
+    int pendingReserveTypes = 0;
+};
+
+// the registry stores components with the pool backend unless built with ECS_ARCHETYPE_STORAGE
+#ifdef ECS_ARCHETYPE_STORAGE
+typedef ArchetypeStorage ComponentStorage;
+#else
+typedef PoolStorage ComponentStorage;
+#endif
+
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// VIEW
+// iterates every entity owning all of the given components, without copies
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+template <typename ...TComponents>
+class ComponentView {
+public:
+    ComponentView(class Registry* registry, const ComponentStorage* storage): registry(registry), storage(storage) {}
+
+    // calls func(Entity, TComponents&...) for each matching entity
+    // (components must not be added/removed while iterating, kills are deferred so they are fine)
+    template <typename TFunc> void Each(TFunc&& func) const {
+        storage->template Each<TComponents...>(registry, std::forward<TFunc>(func));
+    }
+
+    // same as Each, split into chunks run in parallel (func must only touch its own entity's data)
+    template <typename TFunc> void ParallelEach(ThreadPool& threadPool, TFunc&& func) const {
+        storage->template ParallelEach<TComponents...>(registry, threadPool, std::forward<TFunc>(func));
+    }
+
+private:
+    class Registry* registry;
+    const ComponentStorage* storage;
 };
 
 
@@ -227,19 +807,30 @@ private:
 class Registry {
 public:
     Registry() {
-        spdlog::info("Registry constructor called");
+        LOG_INFO(LogCategory::ECS, "Registry constructor called");
     }
-        
+
     ~Registry() {
-        spdlog::info("Registry destructor called");
+        LOG_INFO(LogCategory::ECS, "Registry destructor called");
     }
 
     // the registry Update() finally processes the entities that are waiting to be added/killed to the systems
     void Update();
-        
+
     // entity management
     Entity CreateEntity();
+
+    // creates count entities at once, each initializer is called as initializer(index) and
+    // returns one component, e.g. CreateEntities(n, [](int i) { return TransformComponent(...); })
+    template <typename ...TInitializers> std::vector<Entity> CreateEntities(int count, TInitializers&& ...initializers);
+
+    // safe to call from systems running in parallel, the kill itself is deferred to Update()
     void KillEntity(Entity entity);
+    bool IsAlive(Entity entity) const;
+    Entity GetEntityById(int entityId) const;
+
+    // the components the entity has (an empty signature once the entity is dead)
+    const Signature& GetEntitySignature(Entity entity) const;
 
     // tag management
     void TagEntity(Entity entity, const std::string& tag);
@@ -258,6 +849,14 @@ public:
     template <typename TComponent> void RemoveComponent(Entity entity);
 	template <typename TComponent> bool HasComponent(Entity entity) const;
     template <typename TComponent> TComponent& GetComponent(Entity entity) const;
+    template <typename TComponent> TComponent* TryGetComponent(Entity entity) const;
+
+    // pre-size the storage of a component type (e.g. at level load, so bursts don't grow it mid-frame)
+    template <typename TComponent> void ReservePool(int capacity);
+    template <typename TComponent> PoolStats GetPoolStats() const;
+
+    // iterate all entities that have every one of the given components
+    template <typename ...TComponents> ComponentView<TComponents...> View();
 
     // system management
     template <typename TSystem, typename ...TArgs> void AddSystem(TArgs&& ...args);
@@ -269,13 +868,30 @@ public:
     void AddEntityToSystems(Entity entity);
     void RemoveEntityFromSystems(Entity entity);
 
+    // re-match an entity against every system after its signature changed
+    void UpdateEntityInSystems(Entity entity);
+
 private:
-    int numEntities = 0;
+    // one slot per entity id, the generation is bumped every time the id is freed
+    // free slots form a singly linked list through nextFreeId (ENTITY_ALIVE marks used slots)
+    struct EntitySlot {
+        int generation = 0;
+        int nextFreeId = ENTITY_ALIVE;
+        bool isFlaggedForUpdate = false;
+        bool isFlaggedForKill = false;
+    };
+    static constexpr int ENTITY_ALIVE = -2;
+    static constexpr int NO_FREE_ID = -1;
 
-    // vector of component pools, each pool contains all the data for a certain compoenent type
-    // [Vector index = component type id]
-    // [Pool index = entity id]
-    std::vector<std::shared_ptr<IPool>> componentPools;
+    // [Vector index = entity id]
+    std::vector<EntitySlot> entitySlots;
+    int firstFreeId = NO_FREE_ID;
+
+    // memory the component storage allocates its chunks from (declared first so it outlives the storage)
+    MemoryArena arena;
+
+    // component data of every entity, kept by the backend selected at compile time
+    ComponentStorage componentStorage{arena};
 
     // vector of component signatures per entity, saying which component is turned "on" for a given entity
     // [Vector index = entity id]
@@ -285,9 +901,30 @@ private:
     // [Map key = system type id]
     std::unordered_map<std::type_index, std::shared_ptr<System>> systems;
 
-    // set of entities that are flagged to be added or removed in the next registry Update()
-    std::set<Entity> entitiesToBeAdded;
-    std::set<Entity> entitiesToBeKilled;
+    // the same systems packed next to their signatures, so matching an entity is a scan of contiguous signatures
+    std::vector<System*> systemList;
+    std::vector<Signature> systemSignatures;
+
+    // takes an id from the free list (or a new one) and returns its handle
+    Entity AllocateEntity();
+
+    // flags an entity whose system membership must be re-matched in the next registry Update()
+    void FlagForUpdate(Entity entity);
+
+    // entities that are flagged to be (re)matched or removed in the next registry Update()
+    // (the flags in EntitySlot keep each entity in these lists at most once)
+    std::vector<Entity> entitiesToBeUpdated;
+    std::vector<Entity> entitiesToBeKilled;
+
+    // systems running in parallel may kill entities at the same time
+    std::mutex killMutex;
+
+    // entities created together by CreateEntities(), all sharing one signature
+    struct EntityBatch {
+        Signature signature;
+        std::vector<Entity> entities;
+    };
+    std::vector<EntityBatch> batchesToBeAdded;
 
     // entity tags (one tag name per entity)
     std::unordered_map<std::string, Entity> entityPerTag;
@@ -296,9 +933,6 @@ private:
     // entity groups (a set of entities per group name
     std::unordered_map<std::string, std::set<Entity>> entitiesPerGroup;
     std::unordered_map<int, std::string> groupPerEntity;
-
-    // list of free (available) entity ids that were previously removed
-    std::deque<int> freeIds;
 };
 
 
@@ -329,23 +963,369 @@ TComponent& Entity::GetComponent() const {
     return registry->GetComponent<TComponent>(*this);
 }
 
+template <typename TComponent>
+TComponent* Entity::TryGetComponent() const {
+    return registry->TryGetComponent<TComponent>(*this);
+}
+
 // SYSTEM ----------------------------------------------------------------------
 template <typename TComponent>
 void System::RequireComponent() {
     const auto componentId = Component<TComponent>::GetId();
-    componentSignature.set(componentId);
+    componentSignature.Set(componentId);
+}
+
+template <typename TComponent>
+void System::ReadsComponent() {
+    readSignature.Set(Component<TComponent>::GetId());
+}
+
+template <typename TComponent>
+void System::WritesComponent() {
+    writeSignature.Set(Component<TComponent>::GetId());
+}
+
+// POOL STORAGE ----------------------------------------------------------------
+template <typename TComponent>
+Pool<TComponent>* PoolStorage::GetPool() const {
+    const auto componentId = Component<TComponent>::GetId();
+    if (componentId >= componentPools.size()) {
+        return nullptr;
+    }
+    return static_cast<Pool<TComponent>*>(componentPools[componentId].get());
+}
+
+template <typename TComponent, typename ...TArgs>
+TComponent& PoolStorage::Emplace(int entityId, const Signature&, TArgs&& ...args) {
+    return GetOrCreatePool<TComponent>()->Emplace(entityId, std::forward<TArgs>(args)...);
+}
+
+template <typename ...TComponents, typename ...TInitializers>
+void PoolStorage::EmplaceBulk(std::span<const Entity> entities, TInitializers&& ...initializers) {
+    auto emplaceAll = [&](auto* typeTag, auto& initializer) {
+        using TComponent = std::remove_pointer_t<decltype(typeTag)>;
+        if (entities.empty()) {
+            return;
+        }
+
+        // grow the pool once for the whole batch
+        Pool<TComponent>* pool = GetOrCreatePool<TComponent>();
+        pool->Reserve(pool->GetSize() + static_cast<int>(entities.size()));
+        for (size_t i = 0; i < entities.size(); i++) {
+            pool->Emplace(entities[i].GetId(), initializer(static_cast<int>(i)));
+        }
+    };
+    (emplaceAll(static_cast<TComponents*>(nullptr), initializers), ...);
+}
+
+template <typename TComponent>
+void PoolStorage::Remove(int entityId, const Signature&) {
+    GetPool<TComponent>()->Remove(entityId);
+}
+
+template <typename TComponent>
+TComponent& PoolStorage::Get(int entityId) const {
+    return GetPool<TComponent>()->Get(entityId);
+}
+
+template <typename TComponent>
+Pool<TComponent>* PoolStorage::GetOrCreatePool() {
+    const auto componentId = Component<TComponent>::GetId();
+
+    if (componentId >= componentPools.size()) {
+        componentPools.resize(componentId + 1, nullptr);
+    }
+
+    if (!componentPools[componentId]) {
+        std::shared_ptr<Pool<TComponent>> newComponentPool = std::make_shared<Pool<TComponent>>(arena);
+        componentPools[componentId] = newComponentPool;
+    }
+
+    return static_cast<Pool<TComponent>*>(componentPools[componentId].get());
+}
+
+template <typename TComponent>
+void PoolStorage::Reserve(int capacity) {
+    GetOrCreatePool<TComponent>()->Reserve(capacity);
+}
+
+template <typename TComponent>
+PoolStats PoolStorage::GetStats() const {
+    const auto pool = GetPool<TComponent>();
+    return pool ? pool->GetStats() : PoolStats();
+}
+
+template <typename TComponent>
+int PoolStorage::Count() const {
+    const auto pool = GetPool<TComponent>();
+    return pool ? pool->GetSize() : 0;
+}
+
+template <typename ...TComponents, typename TFunc>
+void PoolStorage::Each(Registry* registry, TFunc&& func) const {
+    auto runSerial = [](size_t count, size_t, auto&& body) {
+        body(size_t(0), count);
+    };
+    EachInRanges<TComponents...>(registry, runSerial, func);
+}
+
+template <typename ...TComponents, typename TFunc>
+void PoolStorage::ParallelEach(Registry* registry, ThreadPool& threadPool, TFunc&& func) const {
+    auto runParallel = [&threadPool](size_t count, size_t grainSize, auto&& body) {
+        threadPool.ParallelFor(0, count, grainSize, body);
+    };
+    EachInRanges<TComponents...>(registry, runParallel, func);
+}
+
+template <typename ...TComponents, typename TRunRanges, typename TFunc>
+void PoolStorage::EachInRanges(Registry* registry, TRunRanges&& runRanges, TFunc&& func) const {
+    const auto pools = std::make_tuple(GetPool<TComponents>()...);
+
+    // a missing or empty pool means no entity can match
+    const bool anyEmpty = std::apply([](auto* ...pool) {
+        return (... || (pool == nullptr || pool->IsEmpty()));
+    }, pools);
+    if (anyEmpty) {
+        return;
+    }
+
+    // drive the iteration from the smallest pool's packed entity ids
+    std::span<const int> entityIds;
+    bool picked = false;
+    auto pickSmallest = [&](auto* pool) {
+        if (!picked || pool->GetSize() < static_cast<int>(entityIds.size())) {
+            entityIds = pool->GetEntityIds();
+            picked = true;
+        }
+    };
+    std::apply([&](auto* ...pool) { (pickSmallest(pool), ...); }, pools);
+
+    runRanges(entityIds.size(), PARALLEL_GRAIN_SIZE, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const int entityId = entityIds[i];
+            const bool hasAll = std::apply([entityId](auto* ...pool) {
+                return (... && pool->Contains(entityId));
+            }, pools);
+            if (!hasAll) {
+                continue;
+            }
+
+            const Entity entity = registry->GetEntityById(entityId);
+            std::apply([&](auto* ...pool) { func(entity, pool->Get(entityId)...); }, pools);
+        }
+    });
+}
+
+// ARCHETYPE STORAGE -----------------------------------------------------------
+template <typename TComponent>
+void ArchetypeStorage::RegisterComponentType() {
+    const auto componentId = Component<TComponent>::GetId();
+    if (componentId >= componentTypeInfos.size()) {
+        componentTypeInfos.resize(componentId + 1);
+    }
+
+    ComponentTypeInfo& info = componentTypeInfos[componentId];
+    if (info.size == 0) {
+        info.size = sizeof(TComponent);
+        info.alignment = alignof(TComponent);
+        info.moveConstruct = [](void* destination, void* source) {
+            new (destination) TComponent(std::move(*static_cast<TComponent*>(source)));
+        };
+        info.destroy = [](void* object) {
+            static_cast<TComponent*>(object)->~TComponent();
+        };
+    }
+}
+
+template <typename TComponent, typename ...TArgs>
+TComponent& ArchetypeStorage::Emplace(int entityId, const Signature&, TArgs&& ...args) {
+    RegisterComponentType<TComponent>();
+    ReservePending();
+    const auto componentId = Component<TComponent>::GetId();
+    EntityLocation& location = GetLocation(entityId);
+
+    // if the entity already has the component, replace it in place
+    if (location.archetype && location.archetype->HasColumn(componentId)) {
+        auto& component = *static_cast<TComponent*>(location.archetype->GetComponent(location.row, componentId));
+        component = TComponent(std::forward<TArgs>(args)...);
+        return component;
+    }
+
+    // otherwise move the entity to the archetype with one more column and construct the new component there
+    MoveEntity(entityId, GetAddTarget(location.archetype, componentId));
+    void* address = location.archetype->GetComponent(location.row, componentId);
+    return *new (address) TComponent(std::forward<TArgs>(args)...);
+}
+
+template <typename ...TComponents, typename ...TInitializers>
+void ArchetypeStorage::EmplaceBulk(std::span<const Entity> entities, TInitializers&& ...initializers) {
+    (RegisterComponentType<TComponents>(), ...);
+    ReservePending();
+
+    // the entities are new, so they all go straight into the archetype of the full signature
+    Signature signature;
+    (signature.Set(Component<TComponents>::GetId()), ...);
+    Archetype* archetype = GetArchetype(signature);
+    if (!archetype || entities.empty()) {
+        return;
+    }
+
+    archetype->Reserve(archetype->GetSize() + static_cast<int>(entities.size()));
+    int maxEntityId = 0;
+    for (const auto& entity : entities) {
+        maxEntityId = std::max(maxEntityId, entity.GetId());
+    }
+    GetLocation(maxEntityId);
+
+    for (size_t i = 0; i < entities.size(); i++) {
+        const int entityId = entities[i].GetId();
+        const int row = archetype->AllocateRow(entityId);
+        entityLocations[entityId] = {archetype, row};
+        (new (archetype->GetComponent(row, Component<TComponents>::GetId())) TComponents(initializers(static_cast<int>(i))), ...);
+    }
+}
+
+template <typename TComponent>
+void ArchetypeStorage::Remove(int entityId, const Signature& signature) {
+    const auto componentId = Component<TComponent>::GetId();
+    // an entity without the component is in an archetype without its column (or in none)
+    if (!signature.Test(componentId)) {
+        return;
+    }
+    EntityLocation& location = GetLocation(entityId);
+    MoveEntity(entityId, GetRemoveTarget(location.archetype, componentId));
+}
+
+template <typename TComponent>
+TComponent& ArchetypeStorage::Get(int entityId) const {
+    const EntityLocation& location = entityLocations[entityId];
+    return *static_cast<TComponent*>(location.archetype->GetComponent(location.row, Component<TComponent>::GetId()));
+}
+
+template <typename TComponent>
+void ArchetypeStorage::Reserve(int capacity) {
+    // adding up the types and reserving once keeps each reservation from abandoning the block of the last one
+    pendingReserveBytes += static_cast<size_t>(std::max(capacity, 0)) * sizeof(TComponent);
+    pendingReserveRows = std::max(pendingReserveRows, capacity);
+    pendingReserveTypes++;
+}
+
+template <typename TComponent>
+PoolStats ArchetypeStorage::GetStats() const {
+    PoolStats stats;
+    const auto componentId = Component<TComponent>::GetId();
+    for (const auto archetype : archetypeList) {
+        if (archetype->HasColumn(componentId)) {
+            stats.bytesReserved += static_cast<size_t>(archetype->GetChunkCount()) * archetype->GetChunkCapacity() * sizeof(TComponent);
+            stats.bytesUsed += static_cast<size_t>(archetype->GetSize()) * sizeof(TComponent);
+            stats.growEvents += archetype->GetGrowEvents();
+            stats.highWaterMark += static_cast<size_t>(archetype->GetHighWaterMark()) * sizeof(TComponent);
+        }
+    }
+    return stats;
+}
+
+template <typename TComponent>
+int ArchetypeStorage::Count() const {
+    const auto componentId = Component<TComponent>::GetId();
+    int count = 0;
+    for (const auto archetype : archetypeList) {
+        if (archetype->HasColumn(componentId)) {
+            count += archetype->GetSize();
+        }
+    }
+    return count;
+}
+
+template <typename ...TComponents, typename TFunc>
+void ArchetypeStorage::Each(Registry* registry, TFunc&& func) const {
+    auto runSerial = [](size_t count, size_t, auto&& body) {
+        body(size_t(0), count);
+    };
+    EachInRanges<TComponents...>(registry, runSerial, func);
+}
+
+template <typename ...TComponents, typename TFunc>
+void ArchetypeStorage::ParallelEach(Registry* registry, ThreadPool& threadPool, TFunc&& func) const {
+    auto runParallel = [&threadPool](size_t count, size_t grainSize, auto&& body) {
+        threadPool.ParallelFor(0, count, grainSize, body);
+    };
+    EachInRanges<TComponents...>(registry, runParallel, func);
+}
+
+template <typename ...TComponents, typename TRunRanges, typename TFunc>
+void ArchetypeStorage::EachInRanges(Registry* registry, TRunRanges&& runRanges, TFunc&& func) const {
+    Signature required;
+    (required.Set(Component<TComponents>::GetId()), ...);
+
+    for (const auto archetype : archetypeList) {
+        if (!archetype->GetSignature().Includes(required)) {
+            continue;
+        }
+
+        // stream each chunk's columns in lockstep, a chunk is the unit of parallel work
+        runRanges(static_cast<size_t>(archetype->GetChunkCount()), 1, [&](size_t begin, size_t end) {
+            for (int chunk = static_cast<int>(begin); chunk < static_cast<int>(end); chunk++) {
+                const int chunkSize = archetype->GetChunkSize(chunk);
+                const int* entityIds = archetype->GetEntityIds(chunk);
+                const auto columns = std::make_tuple(static_cast<TComponents*>(archetype->GetColumn(chunk, Component<TComponents>::GetId()))...);
+
+                for (int row = 0; row < chunkSize; row++) {
+                    const Entity entity = registry->GetEntityById(entityIds[row]);
+                    std::apply([&](auto* ...column) { func(entity, column[row]...); }, columns);
+                }
+            }
+        });
+    }
 }
 
 // REGISTRY --------------------------------------------------------------------
+template <typename ...TInitializers>
+std::vector<Entity> Registry::CreateEntities(int count, TInitializers&& ...initializers) {
+    std::vector<Entity> entities;
+    if (count <= 0) {
+        return entities;
+    }
+
+    // allocate every id first, growing the per-entity tables once
+    entities.reserve(count);
+    entitySlots.reserve(entitySlots.size() + count);
+    for (int i = 0; i < count; i++) {
+        entities.push_back(AllocateEntity());
+    }
+    entityComponentSignatures.resize(entitySlots.size());
+
+    // all entities of the batch share the same signature
+    Signature signature;
+    (signature.Set(Component<std::decay_t<std::invoke_result_t<TInitializers&, int>>>::GetId()), ...);
+    for (const auto& entity : entities) {
+        entityComponentSignatures[entity.GetId()] = signature;
+    }
+
+    componentStorage.EmplaceBulk<std::decay_t<std::invoke_result_t<TInitializers&, int>>...>(entities, std::forward<TInitializers>(initializers)...);
+
+    // systems pick up the whole batch in the next registry Update()
+    batchesToBeAdded.push_back({signature, entities});
+
+    LOG_DEBUG(LogCategory::ECS, "{} entities created in bulk", count);
+
+    return entities;
+}
+
 template <typename TSystem, typename ...TArgs>
 void Registry::AddSystem(TArgs&& ...args) {
     std::shared_ptr<TSystem> newSystem = std::make_shared<TSystem>(std::forward<TArgs>(args)...);
     systems.insert(std::make_pair(std::type_index(typeid(TSystem)), newSystem));
+    systemList.push_back(newSystem.get());
+    systemSignatures.push_back(newSystem->GetComponentSignature());
 }
 
 template <typename TSystem>
 void Registry::RemoveSystem() {
     auto system = systems.find(std::type_index(typeid(TSystem)));
+    const auto index = std::find(systemList.begin(), systemList.end(), system->second.get()) - systemList.begin();
+    systemList.erase(systemList.begin() + index);
+    systemSignatures.erase(systemSignatures.begin() + index);
     systems.erase(system);
 }
 
@@ -365,26 +1345,19 @@ void Registry::AddComponent(Entity entity, TArgs&& ...args) {
     const auto componentId = Component<TComponent>::GetId();
     const auto entityId = entity.GetId();
 
-    if (componentId >= componentPools.size()) {
-        componentPools.resize(componentId + 1, nullptr);
-    }
-
-    if (!componentPools[componentId]) {
-        std::shared_ptr<Pool<TComponent>> newComponentPool = std::make_shared<Pool<TComponent>>();
-        componentPools[componentId] = newComponentPool;
+    // a stale handle would write into whatever entity now owns the id
+    if (!IsAlive(entity)) {
+        LOG_WARN(LogCategory::ECS, "Ignoring component id = {} added to stale entity {}", componentId, entityId);
+        return;
     }
 
-    std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
-
-    TComponent newComponent(std::forward<TArgs>(args)...);
+    componentStorage.Emplace<TComponent>(entityId, entityComponentSignatures[entityId], std::forward<TArgs>(args)...);
 
-    componentPool->Set(entityId, newComponent);
+    entityComponentSignatures[entityId].Set(componentId);
+    FlagForUpdate(entity);
 
-    entityComponentSignatures[entityId].set(componentId);
+    LOG_DEBUG(LogCategory::ECS, "Component id = {} was added to entity id {}", componentId, entityId);
 
-    spdlog::info("Component id = " + std::to_string(componentId) + " was added to entity id " + std::to_string(entityId));
-
-    std::cout << "COMPONENT ID = " << componentId << " --> POOL SIZE: " << componentPool->GetSize() << std::endl;
 }
 
 template <typename TComponent>
@@ -392,29 +1365,55 @@ void Registry::RemoveComponent(Entity entity) {
 	const auto componentId = Component<TComponent>::GetId();
 	const auto entityId = entity.GetId();
 
+    // nothing to remove (the storage expects the component to be there)
+    if (!HasComponent<TComponent>(entity)) {
+        return;
+    }
+
     // remove the component from the component list for that entity
-    std::shared_ptr<Pool<TComponent>> componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
-    componentPool->Remove(entityId);
+    componentStorage.Remove<TComponent>(entityId, entityComponentSignatures[entityId]);
 
     // set this component signature for that entity to false
-	entityComponentSignatures[entityId].set(componentId, false);
-    
-    spdlog::info("Component id = " + std::to_string(componentId) + " was removed from entity id " + std::to_string(entityId));
+	entityComponentSignatures[entityId].Reset(componentId);
+    FlagForUpdate(entity);
+
+    LOG_DEBUG(LogCategory::ECS, "Component id = {} was removed from entity id {}", componentId, entityId);
 }
 
 template <typename TComponent>
 bool Registry::HasComponent(Entity entity) const {
 	const auto componentId = Component<TComponent>::GetId();
 	const auto entityId = entity.GetId();
-	return entityComponentSignatures[entityId].test(componentId);
+	return IsAlive(entity) && entityComponentSignatures[entityId].Test(componentId);
 }
 
 template <typename TComponent>
 TComponent& Registry::GetComponent(Entity entity) const {
-	const auto componentId = Component<TComponent>::GetId();
-	const auto entityId = entity.GetId();
-    auto componentPool = std::static_pointer_cast<Pool<TComponent>>(componentPools[componentId]);
-    return componentPool->Get(entityId);
+    assert(HasComponent<TComponent>(entity) && "GetComponent on a dead entity or a missing component");
+    return componentStorage.Get<TComponent>(entity.GetId());
+}
+
+template <typename TComponent>
+TComponent* Registry::TryGetComponent(Entity entity) const {
+    if (!HasComponent<TComponent>(entity)) {
+        return nullptr;
+    }
+    return &componentStorage.Get<TComponent>(entity.GetId());
+}
+
+template <typename TComponent>
+void Registry::ReservePool(int capacity) {
+    componentStorage.Reserve<TComponent>(capacity);
+}
+
+template <typename TComponent>
+PoolStats Registry::GetPoolStats() const {
+    return componentStorage.GetStats<TComponent>();
+}
+
+template <typename ...TComponents>
+ComponentView<TComponents...> Registry::View() {
+    return ComponentView<TComponents...>(this, &componentStorage);
 }
 
 #endif
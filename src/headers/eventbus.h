@@ -15,97 +15,534 @@
 #define EVENTBUS_H
 
 #include "event.h"
-#include <spdlog/spdlog.h>
-#include <map>
-#include <typeindex>
-#include <list>
-#include <functional>
+#include "events.h"
+#include "logger.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <vector>
 
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
-// EVENT CALLBACK
+// EVENT DELEGATE
+// callable stored in place (no heap, no virtual call): an owner and member
+// function, or a small trivially copyable lambda
+// [TArgument = TEvent& for single events, std::span<const TEvent> for batches]
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
-class IEventCallback {
+template <typename TArgument>
+class EventDelegate {
 public:
-    virtual ~IEventCallback() = default;
+    static constexpr size_t STORAGE_BYTES = 32;
 
-    void Execute(Event& e) {
-        Call(e);
+    template <typename TOwner>
+    EventDelegate(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TArgument)) {
+        struct Bound {
+            TOwner* ownerInstance;
+            void (TOwner::*callbackFunction)(TArgument);
+        };
+        Store(Bound{ownerInstance, callbackFunction}, [](const void* storage, TArgument argument) {
+            const Bound& bound = *static_cast<const Bound*>(storage);
+            (bound.ownerInstance->*bound.callbackFunction)(argument);
+        });
+    }
+
+    template <typename TFunc, typename = std::enable_if_t<std::is_invocable_v<const TFunc&, TArgument>>>
+    explicit EventDelegate(TFunc func) {
+        Store(func, [](const void* storage, TArgument argument) {
+            (*static_cast<const TFunc*>(storage))(argument);
+        });
+    }
+
+    void operator ()(TArgument argument) const {
+        invoker(storage, argument);
     }
 
 private:
-    virtual void Call(Event& e) = 0;
+    template <typename TCallable>
+    void Store(const TCallable& callable, void (*callableInvoker)(const void*, TArgument)) {
+        static_assert(sizeof(TCallable) <= STORAGE_BYTES, "event handler doesn't fit in the delegate storage");
+        static_assert(alignof(TCallable) <= alignof(std::max_align_t), "event handler is over-aligned");
+        static_assert(std::is_trivially_copyable_v<TCallable>, "event handler must be trivially copyable");
+        new (storage) TCallable(callable);
+        invoker = callableInvoker;
+    }
+
+    alignas(std::max_align_t) std::byte storage[STORAGE_BYTES];
+    void (*invoker)(const void*, TArgument) = nullptr;
 };
 
-template <typename TOwner, typename TEvent>
-class EventCallback : public IEventCallback {
-private:
-    typedef void (TOwner::*CallbackFunction)(TEvent&);
+// events that involve entities list them with GetEntities() (e.g. the collision events)
+template <typename TEvent>
+concept EventWithEntities = requires(const TEvent& event) {
+    { *std::begin(event.GetEntities()) } -> std::convertible_to<Entity>;
+};
 
-    TOwner* ownerInstance;
-    CallbackFunction callbackFunction;
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// EVENT FILTER
+// limits a subscription to the events involving one entity, and/or an entity
+// with all the given components (an event passes when any of its entities does)
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+struct EventFilter {
+    Signature signature;
+    Entity entity{-1};
+    bool hasEntity = false;
 
-    virtual void Call(Event& e) override {
-        std::invoke(callbackFunction, ownerInstance, static_cast<TEvent&>(e));
+    static EventFilter ForEntity(Entity entity) {
+        EventFilter filter;
+        filter.entity = entity;
+        filter.hasEntity = true;
+        return filter;
     }
 
-public:
-    EventCallback(TOwner* ownerInstance, CallbackFunction callbackFunction) {
-        this->ownerInstance = ownerInstance;
-        this->callbackFunction = callbackFunction;
+    template <typename ...TComponents>
+    static EventFilter WithComponents() {
+        EventFilter filter;
+        (filter.signature.Set(Component<TComponents>::GetId()), ...);
+        return filter;
+    }
+
+    bool IsEmpty() const {
+        return !hasEntity && signature.None();
+    }
+
+    bool Matches(Entity other) const {
+        if (hasEntity && other != entity) {
+            return false;
+        }
+        return signature.None() || other.registry->GetEntitySignature(other).Includes(signature);
     }
 
-    virtual ~EventCallback() override = default;
+    template <typename TEvent>
+    bool Accepts(const TEvent& event) const {
+        if constexpr (EventWithEntities<TEvent>) {
+            if (IsEmpty()) {
+                return true;
+            }
+            for (const Entity& eventEntity : event.GetEntities()) {
+                if (Matches(eventEntity)) {
+                    return true;
+                }
+            }
+            return false;
+        } else {
+            return true;
+        }
+    }
 };
 
-typedef std::list<std::unique_ptr<IEventCallback>> HandlerList;
+// returned by a subscription, passed back to unsubscribe
+struct EventSubscription {
+    int eventId = -1;
+    uint32_t id = 0;
+};
+
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+// EVENT STATS
+// per event type counters, only kept when built with ENGINE_EVENT_STATS=1
+// (make EVENT_STATS=1), otherwise the bookkeeping is compiled out
+// _____________________________________________________________________________
+// -----------------------------------------------------------------------------
+#ifndef ENGINE_EVENT_STATS
+#define ENGINE_EVENT_STATS 0
+#endif
+
+struct EventCounters {
+    uint64_t emits = 0;             // EmitEvent() calls
+    uint64_t queued = 0;            // enqueued events handed out by Flush()
+    uint64_t maxQueueDepth = 0;     // largest queue handed out by one Flush()
+    uint64_t invocations = 0;       // handler calls (a batch handler call counts once)
+    std::chrono::nanoseconds handlerTime{0};
+    std::chrono::nanoseconds maxHandlerTime{0};
+
+    void Add(const EventCounters& other);
+};
+
+struct EventStats {
+    const char* eventName = "";
+    EventCounters lastFrame;        // the last frame closed by EndFrame()
+    EventCounters total;            // every frame closed so far
+};
 
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
 // EVENT BUS
+// events are either emitted (handled right away) or enqueued (stored, then
+// handled together when Flush() is called at the frame's sync point)
 // _____________________________________________________________________________
 // -----------------------------------------------------------------------------
 class EventBus {
 public:
     EventBus() {
-        spdlog::info("EventBus constructor called!");
+        SetStatsNames(std::make_index_sequence<EventTypes::size>());
+        LOG_INFO(LogCategory::Events, "EventBus constructor called!");
     }
 
     ~EventBus() {
-        spdlog::info("EventBus destructor called!");
+        LOG_INFO(LogCategory::Events, "EventBus destructor called!");
     }
 
-    // clear the subscriber list
+    // clear the subscriber list and drop the queued events
     void Reset() {
-        subscribers.clear();
+        std::apply([](auto& ...handlers) { (handlers.clear(), ...); }, handlerArrays);
+        std::apply([](auto& ...handlers) { (handlers.clear(), ...); }, batchHandlerArrays);
+        std::apply([](auto& ...queues) { (queues.Clear(), ...); }, eventQueues);
     }
 
-    // subscribe to an event type <T>
+    // subscribe to an event type <T>, the subscription lasts until Unsubscribe() or Reset()
+    // (with a filter, the handler only gets the events whose entities pass it)
     template <typename TEvent, typename TOwner>
-    void SubscribeToEvent(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&)) {
-        if (!subscribers[typeid(TEvent)].get()) {
-            subscribers[typeid(TEvent)] = std::make_unique<HandlerList>();
-        }
-        auto subscriber = std::make_unique<EventCallback<TOwner, TEvent>>(ownerInstance, callbackFunction);
-        subscribers[typeid(TEvent)]->push_back(std::move(subscriber));
+    EventSubscription SubscribeToEvent(TOwner* ownerInstance, void (TOwner::*callbackFunction)(TEvent&), const EventFilter& filter = {}) {
+        return AddHandler<TEvent>(GetHandlers<TEvent>(), EventDelegate<TEvent&>(ownerInstance, callbackFunction), filter);
+    }
+
+    // subscribe a small lambda, e.g. SubscribeToEvent<KeyPressedEvent>([this](KeyPressedEvent& event) {...})
+    template <typename TEvent, typename TFunc>
+    EventSubscription SubscribeToEvent(TFunc func, const EventFilter& filter = {}) {
+        return AddHandler<TEvent>(GetHandlers<TEvent>(), EventDelegate<TEvent&>(func), filter);
     }
 
-    // emit an event of type <T>
+    // subscribe to the enqueued events of type <T>, the handler gets all of them at once on Flush()
+    // (with a filter, only the events whose entities pass it)
+    template <typename TEvent, typename TOwner>
+    EventSubscription SubscribeToEventBatch(TOwner* ownerInstance, void (TOwner::*callbackFunction)(std::span<const TEvent>), const EventFilter& filter = {}) {
+        return AddHandler<TEvent>(GetBatchHandlers<TEvent>(), EventDelegate<std::span<const TEvent>>(ownerInstance, callbackFunction), filter);
+    }
+
+    template <typename TEvent, typename TFunc>
+    EventSubscription SubscribeToEventBatch(TFunc func, const EventFilter& filter = {}) {
+        return AddHandler<TEvent>(GetBatchHandlers<TEvent>(), EventDelegate<std::span<const TEvent>>(func), filter);
+    }
+
+    void Unsubscribe(EventSubscription subscription) {
+        UnsubscribeFrom(subscription, std::make_index_sequence<EventTypes::size>());
+    }
+
+    // emit an event of type <T>, the event is built once and passed to every handler
     template <typename TEvent, typename ...TArgs>
     void EmitEvent(TArgs&& ...args) {
-        auto handlers = subscribers[typeid(TEvent)].get();
-        if (handlers) {
-            for (auto it = handlers->begin(); it != handlers->end(); it++) {
-                auto handler = it->get();
-                TEvent event(std::forward<TArgs>(args)...);
-                handler->Execute(event);
-            }
+        if constexpr (ENGINE_EVENT_STATS) {
+            frameCounters[EventType<TEvent>::GetId()].emits++;
+        }
+
+        auto& handlers = GetHandlers<TEvent>();
+        if (handlers.empty()) {
+            return;
+        }
+
+        TEvent event(std::forward<TArgs>(args)...);
+
+        dispatchDepth++;
+        Dispatch(handlers, event);
+        dispatchDepth--;
+
+        if (dispatchDepth == 0 && hasInactiveHandlers) {
+            RemoveInactiveHandlers();
+        }
+    }
+
+    // queue an event of type <T>, it is handled on the next Flush()
+    template <typename TEvent, typename ...TArgs>
+    void Enqueue(TArgs&& ...args) {
+        GetQueue<TEvent>().GetWriteBuffer().emplace_back(std::forward<TArgs>(args)...);
+    }
+
+    // make room for <count> producers of type <T> events, before they start (see EnqueueFrom())
+    template <typename TEvent>
+    void ReserveProducers(size_t count) {
+        auto& producers = GetQueue<TEvent>().producers;
+        if (producers.size() < count) {
+            producers.resize(count);
+        }
+    }
+
+    // queue an event of type <T> from one of several producers (e.g. the chunks of a
+    // parallel loop): no lock is taken, each producer index must only be used by one
+    // thread at a time, and the producers are merged in index order on the next Flush(),
+    // so the handlers see the same order however the chunks were spread on the threads
+    // (no engine system calls it yet: the collision system diffs its contacts in one pass
+    // on the game thread and uses Enqueue(); tests/eventbus_stress_test.cpp covers it)
+    template <typename TEvent, typename ...TArgs>
+    void EnqueueFrom(size_t producerIndex, TArgs&& ...args) {
+        assert(producerIndex < GetQueue<TEvent>().producers.size() && "EnqueueFrom past the producers made room for by ReserveProducers()");
+        GetQueue<TEvent>().producers[producerIndex].events.emplace_back(std::forward<TArgs>(args)...);
+    }
+
+    // hand the queued events to their handlers, one event type after the other (in event id order):
+    // the batch handlers get the whole queue, then the single event handlers get each event in turn
+    void Flush() {
+        FlushQueues(std::make_index_sequence<EventTypes::size>());
+    }
+
+    // closes the frame: its counters become the lastFrame stats, and are written to the CSV file if one is open
+    void EndFrame();
+
+    // writes every frame's counters to a CSV file, one row per event type per frame
+    void OpenStatsCsv(const std::string& path);
+
+    template <typename TEvent>
+    const EventStats& GetStats() const {
+        return stats[EventType<TEvent>::GetId()];
+    }
+
+    // [Array index = event type id]
+    std::span<const EventStats> GetAllStats() const {
+        return stats;
+    }
+
+    template <typename TEvent>
+    size_t GetQueuedEventCount() {
+        auto& queue = GetQueue<TEvent>();
+        size_t count = queue.GetWriteBuffer().size();
+        for (const auto& producer : queue.producers) {
+            count += producer.events.size();
         }
+        return count;
     }
 
 private:
-    std::map<std::type_index, std::unique_ptr<HandlerList>> subscribers;
+    template <typename TArgument>
+    struct Handler {
+        EventDelegate<TArgument> delegate;
+        EventFilter filter;
+        uint32_t id;
+        bool isActive;
+    };
+
+    // events queued by one producer, on its own cache line so producers don't share one
+    template <typename TEvent>
+    struct alignas(64) ProducerBuffer {
+        std::vector<TEvent> events;
+    };
+
+    // the queued events of a type, in two buffers: events enqueued while a flush
+    // hands out one buffer go to the other one, and wait for the next flush
+    // (the buffers are cleared but keep their capacity)
+    template <typename TEvent>
+    struct EventQueue {
+        using EventT = TEvent;
+
+        std::vector<TEvent> buffers[2];
+        int writeIndex = 0;
+
+        // the events passing the filter of a batch handler, rebuilt for each filtered handler
+        std::vector<TEvent> filteredEvents;
+
+        // [Vector index = producer index]
+        std::vector<ProducerBuffer<TEvent>> producers;
+
+        // append the producer events after the ones enqueued directly, in producer order
+        void MergeProducers() {
+            auto& buffer = GetWriteBuffer();
+            for (auto& producer : producers) {
+                buffer.insert(buffer.end(), std::make_move_iterator(producer.events.begin()), std::make_move_iterator(producer.events.end()));
+                producer.events.clear();
+            }
+        }
+
+        std::vector<TEvent>& GetWriteBuffer() {
+            return buffers[writeIndex];
+        }
+
+        std::vector<TEvent>& SwapBuffers() {
+            std::vector<TEvent>& readBuffer = buffers[writeIndex];
+            writeIndex ^= 1;
+            return readBuffer;
+        }
+
+        void Clear() {
+            buffers[0].clear();
+            buffers[1].clear();
+            for (auto& producer : producers) {
+                producer.events.clear();
+            }
+        }
+    };
+
+    // one contiguous handler array (and one queue) per registered event type
+    // [Tuple index = event type id]
+    template <typename TList> struct EventArrays;
+    template <typename ...TEvents> struct EventArrays<TypeList<TEvents...>> {
+        using Handlers = std::tuple<std::vector<Handler<TEvents&>>...>;
+        using BatchHandlers = std::tuple<std::vector<Handler<std::span<const TEvents>>>...>;
+        using Queues = std::tuple<EventQueue<TEvents>...>;
+        using Types = std::tuple<TEvents...>;
+    };
+
+    template <typename TEvent>
+    std::vector<Handler<TEvent&>>& GetHandlers() {
+        return std::get<EventType<TEvent>::GetId()>(handlerArrays);
+    }
+
+    template <typename TEvent>
+    std::vector<Handler<std::span<const TEvent>>>& GetBatchHandlers() {
+        return std::get<EventType<TEvent>::GetId()>(batchHandlerArrays);
+    }
+
+    template <typename TEvent>
+    EventQueue<TEvent>& GetQueue() {
+        return std::get<EventType<TEvent>::GetId()>(eventQueues);
+    }
+
+    template <typename TEvent, typename TArgument>
+    EventSubscription AddHandler(std::vector<Handler<TArgument>>& handlers, const EventDelegate<TArgument>& delegate, const EventFilter& filter) {
+        assert((EventWithEntities<TEvent> || filter.IsEmpty()) && "only events with entities (GetEntities()) can be filtered");
+        const uint32_t id = nextSubscriptionId++;
+        handlers.push_back({delegate, filter, id, true});
+        return {EventType<TEvent>::GetId(), id};
+    }
+
+    // handlers subscribed while dispatching only get the next events, and a copy of
+    // the handler is called so the array may grow while a handler runs
+    template <typename TEvent>
+    void Dispatch(std::vector<Handler<TEvent&>>& handlers, TEvent& event) {
+        const size_t handlerCount = handlers.size();
+        for (size_t i = 0; i < handlerCount; i++) {
+            if (handlers[i].isActive && handlers[i].filter.Accepts(event)) {
+                const EventDelegate<TEvent&> delegate = handlers[i].delegate;
+                Invoke<TEvent>(delegate, event);
+            }
+        }
+    }
+
+    // calls a handler, timing it when the stats are on (a handler emitting events counts the time of their handlers too)
+    template <typename TEvent, typename TArgument>
+    void Invoke(const EventDelegate<TArgument>& delegate, std::type_identity_t<TArgument> argument) {
+        if constexpr (ENGINE_EVENT_STATS) {
+            const auto start = std::chrono::steady_clock::now();
+            delegate(argument);
+            const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+
+            EventCounters& counters = frameCounters[EventType<TEvent>::GetId()];
+            counters.invocations++;
+            counters.handlerTime += elapsed;
+            counters.maxHandlerTime = std::max(counters.maxHandlerTime, elapsed);
+        } else {
+            delegate(argument);
+        }
+    }
+
+    template <typename TEvent>
+    void DispatchBatch(std::vector<Handler<std::span<const TEvent>>>& handlers, std::span<const TEvent> events, std::vector<TEvent>& filteredEvents) {
+        const size_t handlerCount = handlers.size();
+        for (size_t i = 0; i < handlerCount; i++) {
+            if (!handlers[i].isActive) {
+                continue;
+            }
+            const Handler<std::span<const TEvent>> handler = handlers[i];
+            if (handler.filter.IsEmpty()) {
+                Invoke<TEvent>(handler.delegate, events);
+                continue;
+            }
+
+            filteredEvents.clear();
+            for (const auto& event : events) {
+                if (handler.filter.Accepts(event)) {
+                    filteredEvents.push_back(event);
+                }
+            }
+            if (!filteredEvents.empty()) {
+                Invoke<TEvent>(handler.delegate, std::span<const TEvent>(filteredEvents));
+            }
+        }
+    }
+
+    template <size_t EventId>
+    void FlushQueue() {
+        auto& queue = std::get<EventId>(eventQueues);
+        using TEvent = typename std::remove_reference_t<decltype(queue)>::EventT;
+        queue.MergeProducers();
+        if (queue.GetWriteBuffer().empty()) {
+            return;
+        }
+
+        std::vector<TEvent>& events = queue.SwapBuffers();
+        if constexpr (ENGINE_EVENT_STATS) {
+            EventCounters& counters = frameCounters[EventId];
+            counters.queued += events.size();
+            counters.maxQueueDepth = std::max<uint64_t>(counters.maxQueueDepth, events.size());
+        }
+
+        dispatchDepth++;
+        DispatchBatch<TEvent>(GetBatchHandlers<TEvent>(), events, queue.filteredEvents);
+        auto& handlers = GetHandlers<TEvent>();
+        if (!handlers.empty()) {
+            for (auto& event : events) {
+                Dispatch(handlers, event);
+            }
+        }
+        dispatchDepth--;
+
+        events.clear();
+        if (dispatchDepth == 0 && hasInactiveHandlers) {
+            RemoveInactiveHandlers();
+        }
+    }
+
+    template <size_t ...EventIds>
+    void FlushQueues(std::index_sequence<EventIds...>) {
+        (FlushQueue<EventIds>(), ...);
+    }
+
+    template <size_t ...EventIds>
+    void SetStatsNames(std::index_sequence<EventIds...>) {
+        ((stats[EventIds].eventName = EventType<std::tuple_element_t<EventIds, typename EventArrays<EventTypes>::Types>>::GetName()), ...);
+    }
+
+    template <size_t ...EventIds>
+    void UnsubscribeFrom(EventSubscription subscription, std::index_sequence<EventIds...>) {
+        auto deactivate = [&](auto& handlers) {
+            for (auto& handler : handlers) {
+                if (handler.id == subscription.id) {
+                    handler.isActive = false;
+                    hasInactiveHandlers = true;
+                }
+            }
+        };
+        ((static_cast<int>(EventIds) == subscription.eventId ? deactivate(std::get<EventIds>(handlerArrays)) : void()), ...);
+        ((static_cast<int>(EventIds) == subscription.eventId ? deactivate(std::get<EventIds>(batchHandlerArrays)) : void()), ...);
+
+        // handlers are only removed from the arrays when no emit or flush is walking them
+        if (dispatchDepth == 0) {
+            RemoveInactiveHandlers();
+        }
+    }
+
+    void RemoveInactiveHandlers() {
+        auto removeInactive = [](auto& ...handlers) {
+            (std::erase_if(handlers, [](const auto& handler) { return !handler.isActive; }), ...);
+        };
+        std::apply(removeInactive, handlerArrays);
+        std::apply(removeInactive, batchHandlerArrays);
+        hasInactiveHandlers = false;
+    }
+
+    typename EventArrays<EventTypes>::Handlers handlerArrays;
+    typename EventArrays<EventTypes>::BatchHandlers batchHandlerArrays;
+    typename EventArrays<EventTypes>::Queues eventQueues;
+    uint32_t nextSubscriptionId = 1;
+    int dispatchDepth = 0;
+    bool hasInactiveHandlers = false;
+
+    // [Array index = event type id]
+    std::array<EventCounters, EventTypes::size> frameCounters;
+    std::array<EventStats, EventTypes::size> stats;
+    std::ofstream statsCsv;
+    uint64_t frame = 0;
 };
 
 #endif
@@ -0,0 +1,43 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// events.h
+// registered list of every event type, a type's position in the list is its
+// event id (the index of its handler array in the event bus)
+// -----------------------------------------------------------------------------
+#ifndef EVENTS_H
+#define EVENTS_H
+
+#include "ecs.h"
+#include "collisionevent.h"
+#include "keypressedevent.h"
+
+using EventTypes = TypeList<
+    CollisionBeginEvent,
+    CollisionStayEvent,
+    CollisionEndEvent,
+    KeyPressedEvent
+>;
+
+// Used to assign a unique id to an event type, from its position in EventTypes
+template <typename TEvent>
+class EventType {
+public:
+    static constexpr int ID = TypeIndex<std::remove_cv_t<TEvent>, EventTypes>::value;
+    static_assert(ID != -1, "event type is not registered in EventTypes (events.h)");
+
+    // Returns the unique id of EventType<TEvent>
+    static constexpr int GetId() {return ID;}
+
+    // Returns the event type name, used by the event stats (TEvent::NAME)
+    static constexpr const char* GetName() {return TEvent::NAME;}
+};
+
+#endif
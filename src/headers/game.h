@@ -17,6 +17,8 @@
 #include "ecs.h"
 #include "assetstore.h"
 #include "eventbus.h"
+#include "threadpool.h"
+#include "scheduler.h"
 #include <SDL2/SDL.h>
 
 const int FPS = 60;
@@ -51,6 +53,8 @@ private:
     std::unique_ptr<Registry> registry;
     std::unique_ptr<AssetStore> assetStore;
     std::unique_ptr<EventBus> eventBus;
+    std::unique_ptr<ThreadPool> threadPool;
+    std::unique_ptr<SystemScheduler> scheduler;
 };
 
 #endif
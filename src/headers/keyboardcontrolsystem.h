@@ -34,7 +34,7 @@ public:
     }
 
     void OnKeyPressed(KeyPressedEvent& event) {
-        for (auto entity : GetSystemEntities()) {
+        for (auto entity : GetSystemEntitiesSpan()) {
             const auto keyboardcontrol = entity.GetComponent<KeyboardControlledComponent>();
             auto& sprite = entity.GetComponent<SpriteComponent>();
             auto& rigidbody = entity.GetComponent<RigidBodyComponent>();
@@ -20,6 +20,8 @@
 
 class KeyPressedEvent : public Event {
 public:
+    static constexpr const char* NAME = "KeyPressedEvent";
+
     SDL_Keycode symbol;
     KeyPressedEvent(SDL_Keycode symbol) : symbol(symbol) {}
 };
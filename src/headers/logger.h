@@ -9,30 +9,138 @@
 
 // -----------------------------------------------------------------------------
 // logger.h
-// header file for logger class
+// header file for the engine logging layer: one spdlog logger per subsystem
+// category, an asynchronous sink, compile-time level stripping and per call
+// site rate limiting
 // -----------------------------------------------------------------------------
 #ifndef LOGGER_H
 #define LOGGER_H
 
-#include <vector>
-#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <spdlog/spdlog.h>
 
-enum LogType {
-    LOG_INFO,
-    LOG_WARNING,
-    LOG_ERROR
-};
+// compile-time minimum level, same values as spdlog::level (0 trace ... 6 off)
+// calls below it expand to nothing, so their arguments are never evaluated nor formatted
+#define ENGINE_LOG_LEVEL_TRACE 0
+#define ENGINE_LOG_LEVEL_DEBUG 1
+#define ENGINE_LOG_LEVEL_INFO 2
+#define ENGINE_LOG_LEVEL_WARN 3
+#define ENGINE_LOG_LEVEL_ERROR 4
+#define ENGINE_LOG_LEVEL_OFF 6
+
+#ifndef ENGINE_LOG_LEVEL
+#define ENGINE_LOG_LEVEL ENGINE_LOG_LEVEL_INFO
+#endif
 
-struct LogEntry {
-    LogType type;
-    std::string message;
+enum class LogCategory {
+    Engine,
+    ECS,
+    Assets,
+    Events,
+    Collision,
+    Damage,
+    Count
 };
 
 class Logger {
-    public:
-        static std::vector<LogEntry> messages;
-        static void Log(const std::string& message);
-        static void Err(const std::string& message);
+public:
+    // creates the category loggers; with async on, messages are queued and written by a
+    // background thread (the oldest queued message is dropped if the queue is ever full,
+    // so the game thread never blocks on I/O)
+    static void Initialize(bool async = true);
+
+    // flushes the queued messages and stops the background thread
+    static void Shutdown();
+
+    // logger of a category (spdlog's default logger until Initialize() is called)
+    static spdlog::logger* Get(LogCategory category) {
+        spdlog::logger* logger = loggers[static_cast<int>(category)].get();
+        return logger ? logger : spdlog::default_logger_raw();
+    }
+
+private:
+    static std::shared_ptr<spdlog::logger> loggers[static_cast<int>(LogCategory::Count)];
 };
 
+// lets one message through per interval, and counts the ones it held back
+class LogRateLimiter {
+public:
+    explicit LogRateLimiter(int intervalMs): intervalMs(intervalMs) {}
+
+    // returns true when the message may be logged, suppressed gets how many were dropped since the last one
+    bool Allow(int& suppressed) {
+        const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+        int64_t next = nextAllowedMs.load(std::memory_order_relaxed);
+        if (now < next || !nextAllowedMs.compare_exchange_strong(next, now + intervalMs, std::memory_order_relaxed)) {
+            suppressedCount.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        suppressed = suppressedCount.exchange(0, std::memory_order_relaxed);
+        return true;
+    }
+
+private:
+    const int intervalMs;
+    std::atomic<int64_t> nextAllowedMs = 0;
+    std::atomic<int> suppressedCount = 0;
+};
+
+// LOG_<LEVEL>(category, "format {}", args...)
+#define ENGINE_LOG(level, category, ...) Logger::Get(category)->level(__VA_ARGS__)
+
+// LOG_<LEVEL>_EVERY(category, intervalMs, "format {}", args...), for messages that can fire every frame
+#define ENGINE_LOG_EVERY(level, category, intervalMs, ...) \
+    do { \
+        static LogRateLimiter logRateLimiter(intervalMs); \
+        int logSuppressed = 0; \
+        if (logRateLimiter.Allow(logSuppressed)) { \
+            spdlog::logger* logger = Logger::Get(category); \
+            if (logSuppressed > 0) { \
+                logger->level("({} similar messages suppressed)", logSuppressed); \
+            } \
+            logger->level(__VA_ARGS__); \
+        } \
+    } while (0)
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_TRACE
+#define LOG_TRACE(category, ...) ENGINE_LOG(trace, category, __VA_ARGS__)
+#define LOG_TRACE_EVERY(category, intervalMs, ...) ENGINE_LOG_EVERY(trace, category, intervalMs, __VA_ARGS__)
+#else
+#define LOG_TRACE(category, ...) (void)0
+#define LOG_TRACE_EVERY(category, intervalMs, ...) (void)0
+#endif
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_DEBUG
+#define LOG_DEBUG(category, ...) ENGINE_LOG(debug, category, __VA_ARGS__)
+#define LOG_DEBUG_EVERY(category, intervalMs, ...) ENGINE_LOG_EVERY(debug, category, intervalMs, __VA_ARGS__)
+#else
+#define LOG_DEBUG(category, ...) (void)0
+#define LOG_DEBUG_EVERY(category, intervalMs, ...) (void)0
+#endif
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_INFO
+#define LOG_INFO(category, ...) ENGINE_LOG(info, category, __VA_ARGS__)
+#define LOG_INFO_EVERY(category, intervalMs, ...) ENGINE_LOG_EVERY(info, category, intervalMs, __VA_ARGS__)
+#else
+#define LOG_INFO(category, ...) (void)0
+#define LOG_INFO_EVERY(category, intervalMs, ...) (void)0
+#endif
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_WARN
+#define LOG_WARN(category, ...) ENGINE_LOG(warn, category, __VA_ARGS__)
+#define LOG_WARN_EVERY(category, intervalMs, ...) ENGINE_LOG_EVERY(warn, category, intervalMs, __VA_ARGS__)
+#else
+#define LOG_WARN(category, ...) (void)0
+#define LOG_WARN_EVERY(category, intervalMs, ...) (void)0
+#endif
+
+#if ENGINE_LOG_LEVEL <= ENGINE_LOG_LEVEL_ERROR
+#define LOG_ERROR(category, ...) ENGINE_LOG(error, category, __VA_ARGS__)
+#else
+#define LOG_ERROR(category, ...) (void)0
+#endif
+
 #endif
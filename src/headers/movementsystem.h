@@ -23,17 +23,16 @@ public:
     MovementSystem() {
         RequireComponent<TransformComponent>();
         RequireComponent<RigidBodyComponent>();
+        WritesComponent<TransformComponent>();
+        ReadsComponent<RigidBodyComponent>();
     }
 
-    void Update(double deltaTime) {
-        for (auto entity : GetSystemEntities()) {
-            // update entity position based on its velocity
-            auto& transform = entity.GetComponent<TransformComponent>();
-            const auto rigidbody = entity.GetComponent<RigidBodyComponent>();
-
+    void Update(std::unique_ptr<Registry>& registry, double deltaTime, ThreadPool& threadPool) {
+        // update entity position based on its velocity (each entity only touches its own components)
+        registry->View<TransformComponent, RigidBodyComponent>().ParallelEach(threadPool, [deltaTime](Entity, TransformComponent& transform, const RigidBodyComponent& rigidbody) {
             transform.position.x += rigidbody.velocity.x * deltaTime;
             transform.position.y += rigidbody.velocity.y * deltaTime;
-       }
+        });
     }
 };
 
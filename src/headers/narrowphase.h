@@ -0,0 +1,54 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// narrowphase.h
+// header file for the batched AABB overlap tests run on the broadphase candidates
+// -----------------------------------------------------------------------------
+#ifndef NARROWPHASE_H
+#define NARROWPHASE_H
+
+#include "aabb.h"
+#include <span>
+#include <vector>
+
+// collider bounds as one array per coordinate, so a batch of pairs is tested with
+// one compare per coordinate (8 pairs with AVX2, 4 with SSE)
+// [Vector index = collider index]
+struct ColliderBounds {
+    std::vector<float> minX;
+    std::vector<float> minY;
+    std::vector<float> maxX;
+    std::vector<float> maxY;
+
+    void Resize(size_t count) {
+        minX.resize(count);
+        minY.resize(count);
+        maxX.resize(count);
+        maxY.resize(count);
+    }
+
+    void Set(size_t index, const AABB& bounds) {
+        minX[index] = bounds.minX;
+        minY[index] = bounds.minY;
+        maxX[index] = bounds.maxX;
+        maxY[index] = bounds.maxY;
+    }
+};
+
+// tests every candidate pair (same answers as AABB::Overlaps) and writes the overlapping ones,
+// in order, to overlaps (room for pairs.size() needed), returns how many there are
+size_t FindOverlappingPairs(const ColliderBounds& bounds, std::span<const ColliderPair> pairs, ColliderPair* overlaps);
+
+// swept test of two boxes moving in a straight line from their start to their end bounds during
+// the frame: if they overlap at some point, writes the earliest one to timeOfImpact (0 = start
+// of the frame, 1 = end) and returns true (always true when the end bounds overlap)
+bool FindTimeOfImpact(const AABB& startA, const AABB& endA, const AABB& startB, const AABB& endB, float& timeOfImpact);
+
+#endif
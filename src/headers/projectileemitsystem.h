@@ -28,6 +28,9 @@ public:
     ProjectileEmitSystem() {
         RequireComponent<ProjectileEmitterComponent>();
         RequireComponent<TransformComponent>();
+
+        // creates the projectile entities
+        RequireExclusiveAccess();
     }
 
     void SubscribeToEvents(std::unique_ptr<EventBus>& eventBus) {
@@ -37,7 +40,7 @@ public:
 
     void OnKeyPressed(KeyPressedEvent& event) {
         if (event.symbol == SDLK_SPACE) {
-            for (auto entity : GetSystemEntities()) {
+            for (auto entity : GetSystemEntitiesSpan()) {
                 if (entity.HasComponent < CameraFollowComponent>()) {
                     const auto projectileEmitter = entity.GetComponent<ProjectileEmitterComponent>();
                     const auto transform = entity.GetComponent<TransformComponent>();
@@ -68,7 +71,7 @@ public:
                     projectile.AddComponent<TransformComponent>(projectilePosition, glm::vec2(1.0, 1.0), 0.0);
                     projectile.AddComponent<RigidBodyComponent>(projectileVelocity);
                     projectile.AddComponent<SpriteComponent>("bullet-image", 4, 4, 4);
-                    projectile.AddComponent<BoxColliderComponent>(4, 4);
+                    projectile.AddComponent<BoxColliderComponent>(4, 4, glm::vec2(0), projectileEmitter.isFriendly ? CollisionLayer::PlayerBullet : CollisionLayer::EnemyBullet, true);
                     projectile.AddComponent<ProjectileComponent>(projectileEmitter.isFriendly, projectileEmitter.hitPercentDamage, projectileEmitter.projectileDuration);
                 }
             }
@@ -76,7 +79,7 @@ public:
     }
 
     void Update(std::unique_ptr<Registry>& registry) {
-        for (auto entity : GetSystemEntities()) {
+        for (auto entity : GetSystemEntitiesSpan()) {
             auto& projectileEmitter = entity.GetComponent<ProjectileEmitterComponent>();
             const auto transform = entity.GetComponent<TransformComponent>();
 
@@ -101,7 +104,7 @@ public:
                 projectile.AddComponent<TransformComponent>(projectilePosition, glm::vec2(1.0, 1.0), 0.0);
                 projectile.AddComponent<RigidBodyComponent>(projectileEmitter.projectileVelocity);
                 projectile.AddComponent<SpriteComponent>("bullet-image", 4, 4, 4);
-                projectile.AddComponent<BoxColliderComponent>(4, 4);
+                projectile.AddComponent<BoxColliderComponent>(4, 4, glm::vec2(0), projectileEmitter.isFriendly ? CollisionLayer::PlayerBullet : CollisionLayer::EnemyBullet, true);
                 projectile.AddComponent<ProjectileComponent>(projectileEmitter.isFriendly, projectileEmitter.hitPercentDamage, projectileEmitter.projectileDuration);
 
                 // update the projectile emitter component last emission to the current milliseconds
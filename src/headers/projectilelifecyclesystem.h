@@ -21,10 +21,11 @@ class ProjectileLifecycleSystem : public System {
 public:
     ProjectileLifecycleSystem() {
         RequireComponent<ProjectileComponent>();
+        ReadsComponent<ProjectileComponent>();
     }
     
     void Update() {
-        for (auto entity : GetSystemEntities()) {
+        for (auto entity : GetSystemEntitiesSpan()) {
             auto projectile = entity.GetComponent<ProjectileComponent>();
 
             // kill projectiles after they reach thier duration limit
@@ -27,7 +27,7 @@ public:
     } 
 
     void Update(SDL_Renderer* renderer, SDL_Rect& camera) {
-        for (auto entity : GetSystemEntities()) {
+        for (auto entity : GetSystemEntitiesSpan()) {
             const auto transform = entity.GetComponent<TransformComponent>();
             const auto collider = entity.GetComponent<BoxColliderComponent>();
 
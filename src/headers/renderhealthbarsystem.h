@@ -19,7 +19,10 @@
 #include "transformcomponent.h"
 #include "spritecomponent.h"
 #include "healthcomponent.h"
+#include "visibilityindex.h"
 #include <SDL2/SDL.h>
+#include <algorithm>
+#include <vector>
 
 class RenderHealthBarSystem : public System {
 public:
@@ -30,7 +33,25 @@ public:
     }
 
     void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, const SDL_Rect& camera) {
-        for (auto entity : GetSystemEntities()) {
+        // the bar and its label as drawn at full health (the widest label), so a change of health doesn't move the bounds
+        visibilityIndex.Update(GetSystemEntitiesSpan(), [this, &assetStore](Entity entity) {
+            MeasureFullLabel(*assetStore);
+            const auto& transform = entity.GetComponent<TransformComponent>();
+            const auto& sprite = entity.GetComponent<SpriteComponent>();
+            const float x = transform.position.x + (sprite.width * transform.scale.x);
+            const float y = transform.position.y;
+            const AABB bounds = {x, y, x + std::max(15, fullLabelWidth), y + 5 + fullLabelHeight};
+            return RenderBounds{bounds.Fattened(1.0f), false};
+        });
+        visibleEntities.clear();
+        visibilityIndex.Query(camera, [this](const Entity& entity) {
+            visibleEntities.push_back(entity);
+        });
+        std::sort(visibleEntities.begin(), visibleEntities.end());
+        cullingStats.visible = visibleEntities.size();
+        cullingStats.culled = GetSystemEntitiesSpan().size() - visibleEntities.size();
+
+        for (const auto& entity : visibleEntities) {
             const auto transform = entity.GetComponent<TransformComponent>();
             const auto sprite = entity.GetComponent<SpriteComponent>();
             const auto health = entity.GetComponent<HealthComponent>();
@@ -82,6 +103,33 @@ public:
             SDL_RenderCopy(renderer, texture, NULL, &healthBarTextRectangle);
         }
     }
+
+    const CullingStats& GetCullingStats() const {
+        return cullingStats;
+    }
+
+    // to be called after changing the sprite's size, or its position or scale without a rigid body
+    void InvalidateBounds(Entity entity) {
+        visibilityIndex.Invalidate(entity);
+    }
+
+private:
+    // measured once per font (the assets are reloaded with each level)
+    void MeasureFullLabel(AssetStore& assetStore) {
+        TTF_Font* font = assetStore.GetFont("pico8-font-5");
+        if (font != measuredFont) {
+            TTF_SizeText(font, "100", &fullLabelWidth, &fullLabelHeight);
+            measuredFont = font;
+        }
+    }
+
+    VisibilityIndex visibilityIndex;
+    // the health bars on camera, by entity id
+    std::vector<Entity> visibleEntities;
+    CullingStats cullingStats;
+    TTF_Font* measuredFont = nullptr;
+    int fullLabelWidth = 0;
+    int fullLabelHeight = 0;
 };
 
 #endif
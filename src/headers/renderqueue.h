@@ -0,0 +1,72 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// renderqueue.h
+// header file for the Render Queue, the sprites in draw order kept from one
+// frame to the next (only the sprites that were added or changed get sorted)
+// -----------------------------------------------------------------------------
+#ifndef RENDERQUEUE_H
+#define RENDERQUEUE_H
+
+#include "ecs.h"
+#include "assetstore.h"
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+class RenderQueue {
+public:
+    struct Item {
+        Entity entity;
+
+        // draw order: z-index (16 bits) | texture handle (16 bits) | sequence (32 bits)
+        // the sprites of a z-index are drawn texture by texture, then in the order they were queued
+        uint64_t key;
+        int textureHandle;
+
+        // what the key was made from, a sprite whose values differ is re-keyed
+        int zIndex;
+        std::string assetId;
+    };
+
+    static uint64_t MakeKey(int zIndex, int textureHandle, uint32_t sequence);
+
+    // brings the queue up to date with the sprites of entities (every one of them has a SpriteComponent):
+    // adds the new ones, drops the gone ones, re-keys the changed ones and sorts them back in,
+    // the unchanged ones keep their place (O(n) plus sorting the changes)
+    void Update(std::span<const Entity> entities, const AssetStore& assetStore);
+
+    // the sprites in draw order
+    const std::vector<Item>& GetItems() const {return items;}
+
+    // where the sprite of an entity of the last Update() is in the items
+    int GetItemIndex(int entityId) const {return itemOfId[entityId];}
+
+    // texture changes between consecutive items, what drawing them costs in texture switches
+    size_t GetTextureSwitches() const {return textureSwitches;}
+
+private:
+    std::vector<Item> items;
+
+    // [Vector index = entity id] the item of the entity, and the last update it was seen in
+    std::vector<int> itemOfId;
+    std::vector<uint32_t> frameSeen;
+
+    // the added/re-keyed items, sorted apart then merged with the others
+    std::vector<Item> changedItems;
+    std::vector<Item> mergedItems;
+
+    uint32_t frame = 0;
+    uint32_t nextSequence = 0;
+    size_t textureSwitches = 0;
+};
+
+#endif
@@ -18,6 +18,11 @@
 #include "transformcomponent.h"
 #include "spritecomponent.h"
 #include "assetstore.h"
+#include "renderqueue.h"
+#include "visibilityindex.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
 #include <SDL2/SDL.h>
 
 class RenderSystem: public System {
@@ -28,29 +33,32 @@ public:
     }
 
     void Update(SDL_Renderer* renderer, std::unique_ptr<AssetStore>& assetStore, SDL_Rect& camera) {
-        // create a vector with both sprite and transform component of entities
-        struct RenderableEntity {
-            TransformComponent transformComponent;
-            SpriteComponent spriteComponent;
-        };
-        std::vector<RenderableEntity> renderableEntities;
-        for (auto entity : GetSystemEntities()) {
-            RenderableEntity renderableEntity;
-            renderableEntity.spriteComponent = entity.GetComponent<SpriteComponent>();
-            renderableEntity.transformComponent = entity.GetComponent<TransformComponent>();
-            renderableEntities.emplace_back(renderableEntity);
-        }
+        // the sprites stay queued in draw order from one frame to the next, only the new and changed ones are sorted
+        renderQueue.Update(GetSystemEntitiesSpan(), *assetStore);
+        visibilityIndex.Update(GetSystemEntitiesSpan(), [](Entity entity) {
+            return GetSpriteBounds(entity.GetComponent<TransformComponent>(), entity.GetComponent<SpriteComponent>());
+        });
 
-        // sort the vector by the z-index value
-        std::sort(renderableEntities.begin(), renderableEntities.end(), [](const RenderableEntity& a, const RenderableEntity& b) {
-            return a.spriteComponent.zIndex < b.spriteComponent.zIndex;
+        // only the sprites on camera are drawn, in their queue order
+        visibleItems.clear();
+        visibilityIndex.Query(camera, [this](const Entity& entity) {
+            visibleItems.push_back(renderQueue.GetItemIndex(entity.GetId()));
         });
+        std::sort(visibleItems.begin(), visibleItems.end());
+        cullingStats.visible = visibleItems.size();
+        cullingStats.culled = renderQueue.GetItems().size() - visibleItems.size();
+
+        textureSwitches = 0;
+        int lastTextureHandle = -1;
+        for (const int index : visibleItems) {
+            const auto& item = renderQueue.GetItems()[index];
+            if (textureSwitches == 0 || item.textureHandle != lastTextureHandle) {
+                textureSwitches++;
+                lastTextureHandle = item.textureHandle;
+            }
+            const auto& transform = item.entity.GetComponent<TransformComponent>();
+            const auto& sprite = item.entity.GetComponent<SpriteComponent>();
 
-        for (auto entity : renderableEntities) {
-            // update entity position based on its velocity
-            const auto transform = entity.transformComponent;
-            const auto sprite = entity.spriteComponent;
-            
             // set the source rectangle of our original sprite texture
             SDL_Rect srcRect = sprite.srcRect;
             // set the destination rectangle with x,y position to be rendered
@@ -61,19 +69,55 @@ public:
                 static_cast<int>(sprite.height * transform.scale.y)
             };
 
+            // draw the PNG texture
             SDL_RenderCopyEx(
                 renderer,
-                assetStore->GetTexture(sprite.assetId),
+                assetStore->GetTexture(item.textureHandle),
                 &srcRect,
                 &dstRect,
                 transform.rotation,
                 NULL,
                 SDL_FLIP_NONE
             );
+        }
+    }
 
-            // draw the PNG texture
-      }
+    // texture changes while drawing the last frame (the queue draws the sprites of a z-index texture by texture)
+    size_t GetTextureSwitches() const {
+        return textureSwitches;
     }
+
+    const CullingStats& GetCullingStats() const {
+        return cullingStats;
+    }
+
+    // to be called after changing where a sprite is drawn other than by its rigid body (its size,
+    // scale, rotation or isFixed, or the position of one without a rigid body)
+    void InvalidateBounds(Entity entity) {
+        visibilityIndex.Invalidate(entity);
+    }
+
+private:
+    // where the sprite is drawn (rounded out to whole pixels, a rotated one turns around its center)
+    static RenderBounds GetSpriteBounds(const TransformComponent& transform, const SpriteComponent& sprite) {
+        const float width = sprite.width * transform.scale.x;
+        const float height = sprite.height * transform.scale.y;
+        AABB bounds = {transform.position.x, transform.position.y, transform.position.x + width, transform.position.y + height};
+        if (transform.rotation != 0.0) {
+            const float centerX = transform.position.x + width / 2;
+            const float centerY = transform.position.y + height / 2;
+            const float radius = std::sqrt(width * width + height * height) / 2;
+            bounds = {centerX - radius, centerY - radius, centerX + radius, centerY + radius};
+        }
+        return {bounds.Fattened(1.0f), sprite.isFixed};
+    }
+
+    RenderQueue renderQueue;
+    VisibilityIndex visibilityIndex;
+    // [Vector index = draw order] indices of the visible queue items
+    std::vector<int> visibleItems;
+    CullingStats cullingStats;
+    size_t textureSwitches = 0;
 };
 
 #endif
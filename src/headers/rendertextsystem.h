@@ -17,7 +17,11 @@
 #include "ecs.h"
 #include "textlabelcomponent.h"
 #include "assetstore.h"
+#include "visibilityindex.h"
 #include "SDL2/SDL.h"
+#include <algorithm>
+#include <string>
+#include <vector>
 
 class RenderTextSystem : public System {
 public:
@@ -30,8 +34,23 @@ public:
         std::unique_ptr<AssetStore>& assetStore,
         const SDL_Rect& camera
         ) {
-        for (auto entity : GetSystemEntities()) {
-            const auto textlabel = entity.GetComponent<TextLabelComponent>();
+        // the labels are indexed by their measured size (without rendering them), only the ones on camera are rendered
+        visibilityIndex.Update(GetSystemEntitiesSpan(), [this, &assetStore](Entity entity) {
+            const auto& textlabel = entity.GetComponent<TextLabelComponent>();
+            const LabelSize& size = GetLabelSize(entity.GetId(), textlabel, *assetStore);
+            const AABB bounds = {textlabel.position.x, textlabel.position.y, textlabel.position.x + size.width, textlabel.position.y + size.height};
+            return RenderBounds{bounds.Fattened(1.0f), textlabel.isFixed};
+        });
+        visibleEntities.clear();
+        visibilityIndex.Query(camera, [this](const Entity& entity) {
+            visibleEntities.push_back(entity);
+        });
+        std::sort(visibleEntities.begin(), visibleEntities.end());
+        cullingStats.visible = visibleEntities.size();
+        cullingStats.culled = GetSystemEntitiesSpan().size() - visibleEntities.size();
+
+        for (const auto& entity : visibleEntities) {
+            const auto& textlabel = entity.GetComponent<TextLabelComponent>();
 
             SDL_Surface* surface = TTF_RenderText_Blended(
                 assetStore->GetFont(textlabel.assetId), 
@@ -58,6 +77,44 @@ public:
             SDL_DestroyTexture(texture);
         }
     }
+
+    const CullingStats& GetCullingStats() const {
+        return cullingStats;
+    }
+
+    // to be called after changing a label's text, font, position or isFixed, so it's indexed where it's now drawn
+    void InvalidateBounds(Entity entity) {
+        visibilityIndex.Invalidate(entity);
+    }
+
+private:
+    // the size of a label's text, kept until the text or the font changes
+    struct LabelSize {
+        std::string text;
+        std::string assetId;
+        int width = 0;
+        int height = 0;
+    };
+
+    const LabelSize& GetLabelSize(int entityId, const TextLabelComponent& textlabel, AssetStore& assetStore) {
+        if (entityId >= static_cast<int>(labelSizeOfId.size())) {
+            labelSizeOfId.resize(entityId + 1);
+        }
+        LabelSize& size = labelSizeOfId[entityId];
+        if (size.text != textlabel.text || size.assetId != textlabel.assetId) {
+            size.text = textlabel.text;
+            size.assetId = textlabel.assetId;
+            TTF_SizeText(assetStore.GetFont(textlabel.assetId), textlabel.text.c_str(), &size.width, &size.height);
+        }
+        return size;
+    }
+
+    VisibilityIndex visibilityIndex;
+    // [Vector index = entity id]
+    std::vector<LabelSize> labelSizeOfId;
+    // the labels on camera, by entity id
+    std::vector<Entity> visibleEntities;
+    CullingStats cullingStats;
 };
 
 #endif
@@ -0,0 +1,61 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// scheduler.h
+// header file for the system scheduler: runs the system updates of a frame on
+// the thread pool, in parallel whenever their declared accesses don't conflict
+// -----------------------------------------------------------------------------
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "ecs.h"
+#include "threadpool.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <vector>
+
+class SystemScheduler {
+public:
+    explicit SystemScheduler(ThreadPool& threadPool): threadPool(threadPool) {}
+
+    // queues a system update for this frame; the access declared by the system
+    // (ReadsComponent/WritesComponent/RequireExclusiveAccess) decides what it may run alongside
+    void Add(const System& system, std::function<void()> update);
+
+    // builds the dependency graph of the queued updates, runs them, and clears the queue
+    // an update waits for every earlier queued update it conflicts with, so the results
+    // are the same as running them one after another in the order they were added
+    void Run();
+
+private:
+    struct Task {
+        Signature reads;
+        Signature writes;
+        bool isExclusive;
+        std::function<void()> update;
+        std::vector<int> successors;
+        int predecessorCount = 0;
+    };
+
+    static bool Conflicts(const Task& a, const Task& b);
+
+    void BuildGraph();
+    void RunTask(int index);
+
+    ThreadPool& threadPool;
+    std::vector<Task> tasks;
+
+    // [Array index = task index], predecessors still running
+    std::unique_ptr<std::atomic<int>[]> predecessorsLeft;
+    std::atomic<int> tasksLeft = 0;
+};
+
+#endif
@@ -0,0 +1,73 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// spatialhash.h
+// header file for the uniform grid broadphase (cells hashed into a flat table)
+// -----------------------------------------------------------------------------
+#ifndef SPATIALHASH_H
+#define SPATIALHASH_H
+
+#include "aabb.h"
+#include "broadphase.h"
+#include <cmath>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+class SpatialHash : public IBroadphase {
+public:
+    explicit SpatialHash(float cellSize = 64.0f);
+
+    // cells should be about the size of the common colliders: much smaller and boxes
+    // span many cells, much larger and every cell holds many boxes
+    void SetCellSize(float cellSize);
+    float GetCellSize() const {return cellSize;}
+
+    const char* GetName() const override {return "spatial hash";}
+
+    // rebuilds the grid from the bounds (the ids aren't needed) and fills pairs with the candidates:
+    // every overlapping pair exactly once (plus a few that only share a cell), sorted by (a, b)
+    void FindPairs(std::span<const int> ids, std::span<const AABB> bounds, std::span<const CollisionFilter> filters, std::vector<ColliderPair>& pairs, ThreadPool& threadPool) override;
+
+    // looks the area up cell by cell (or checks every collider if that covers fewer), a collider
+    // covering several of the cells is only visited from the cell holding the min corner of its
+    // overlap with the area
+    void QueryArea(const AABB& area, ColliderVisitor visit, void* context) const override;
+
+private:
+    // one per cell a box covers
+    struct CellEntry {
+        int cellX;
+        int cellY;
+        int index;
+        uint32_t bucket;
+    };
+
+    int CellOf(float coordinate) const {
+        return static_cast<int>(std::floor(coordinate * inverseCellSize));
+    }
+
+    float cellSize;
+    float inverseCellSize;
+
+    // the entries are counting-sorted by bucket, so each bucket is a contiguous run
+    // (kept between frames so a steady scene doesn't allocate)
+    std::vector<CellEntry> entries;
+    std::vector<CellEntry> sortedEntries;
+    std::vector<uint32_t> bucketStarts;
+    uint32_t bucketMask = 0;
+
+    // [Vector index = collider index] the bounds of the last FindPairs(), for the queries
+    std::vector<AABB> colliderBounds;
+
+    PairBuffers pairBuffers;
+};
+
+#endif
@@ -0,0 +1,103 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// threadpool.h
+// header file for the work-stealing thread pool used to run systems in parallel
+// -----------------------------------------------------------------------------
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// every worker owns a task queue: it pops its own newest tasks first, and steals the
+// oldest tasks of the other queues when it runs dry (tasks submitted from outside the
+// pool go to a shared queue); threads waiting on the pool run tasks instead of sleeping
+class ThreadPool {
+public:
+    // defaults to one worker per hardware thread, minus the calling (main) thread
+    explicit ThreadPool(unsigned int threadCount = DefaultThreadCount());
+    ~ThreadPool();
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator =(const ThreadPool&) = delete;
+
+    static unsigned int DefaultThreadCount();
+
+    unsigned int GetThreadCount() const {return static_cast<unsigned int>(workers.size());}
+
+    void Submit(std::function<void()> task);
+
+    // runs queued tasks on the calling thread until done() returns true
+    template <typename TDone>
+    void WaitUntil(TDone&& done) {
+        while (!done()) {
+            if (!TryRunTask()) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // calls func(chunkBegin, chunkEnd) for consecutive chunks of at most grainSize items
+    // covering [begin, end), in parallel, and returns once every chunk is done
+    template <typename TFunc>
+    void ParallelFor(size_t begin, size_t end, size_t grainSize, TFunc&& func) {
+        if (begin >= end) {
+            return;
+        }
+        grainSize = grainSize > 0 ? grainSize : 1;
+        const size_t chunkCount = (end - begin + grainSize - 1) / grainSize;
+        if (chunkCount == 1 || workers.empty()) {
+            func(begin, end);
+            return;
+        }
+
+        // the first chunk runs on the calling thread, the others are up for grabs
+        std::atomic<size_t> chunksLeft = chunkCount - 1;
+        for (size_t chunk = 1; chunk < chunkCount; chunk++) {
+            Submit([&func, &chunksLeft, begin, end, grainSize, chunk]() {
+                const size_t chunkBegin = begin + chunk * grainSize;
+                func(chunkBegin, std::min(end, chunkBegin + grainSize));
+                chunksLeft.fetch_sub(1, std::memory_order_release);
+            });
+        }
+        func(begin, std::min(end, begin + grainSize));
+        WaitUntil([&chunksLeft]() {return chunksLeft.load(std::memory_order_acquire) == 0;});
+    }
+
+private:
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    void WorkerLoop(unsigned int index);
+
+    // pops a task (own queue, then the shared one, then stealing) and runs it
+    bool TryRunTask();
+    bool PopTask(std::function<void()>& task);
+
+    // [Vector index = worker index], the last queue is the shared one
+    std::vector<std::unique_ptr<TaskQueue>> queues;
+    std::vector<std::thread> workers;
+
+    // idle workers sleep until a task is submitted
+    std::mutex sleepMutex;
+    std::condition_variable wakeUp;
+    std::atomic<int> queuedTasks = 0;
+    bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,138 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// visibilityindex.h
+// header file for the Visibility Index, where the things a render system draws
+// are (a dynamic tree of their bounds), so it only draws the ones on camera
+// -----------------------------------------------------------------------------
+#ifndef VISIBILITYINDEX_H
+#define VISIBILITYINDEX_H
+
+#include "ecs.h"
+#include "aabb.h"
+#include "dynamicaabbtree.h"
+#include "rigidbodycomponent.h"
+#include <cstdint>
+#include <span>
+#include <vector>
+#include <SDL2/SDL.h>
+
+// what a render system drew on the last frame, and what it skipped for being off camera
+struct CullingStats {
+    size_t visible = 0;
+    size_t culled = 0;
+};
+
+// where an entity is drawn: in the world, or on the screen for the fixed ones (e.g. the radar)
+struct RenderBounds {
+    AABB bounds;
+    bool isFixed;
+};
+
+class VisibilityIndex {
+public:
+    explicit VisibilityIndex(float margin = 32.0f): worldTree(margin), screenTree(margin) {}
+
+    // brings the index up to date with entities, getBounds(entity) telling where each one is drawn:
+    // the new ones are indexed and the gone ones dropped; after that getBounds is only called again
+    // for the ones with a rigid body (the only things moved every frame) and the ones invalidated
+    // since, so the static ones (e.g. the tiles) cost nothing; an entity switching between the
+    // world and the screen changes tree
+    template <typename TGetBounds>
+    void Update(std::span<const Entity> entities, TGetBounds&& getBounds) {
+        frame++;
+        for (const auto& entity : entities) {
+            const int id = entity.GetId();
+            if (id >= static_cast<int>(trackedOfId.size())) {
+                trackedOfId.resize(id + 1);
+            }
+
+            Tracked& tracked = trackedOfId[id];
+            if (tracked.proxyId == DynamicAABBTree::NULL_NODE) {
+                Insert(entity, getBounds(entity));
+                trackedIds.push_back(id);
+            } else if (tracked.entity != entity) {
+                // the id of a gone entity reused
+                GetTree(tracked.isFixed).DestroyProxy(tracked.proxyId);
+                Insert(entity, getBounds(entity));
+            } else if (tracked.isDirty || entity.HasComponent<RigidBodyComponent>()) {
+                const RenderBounds drawn = getBounds(entity);
+                if (tracked.isFixed != drawn.isFixed) {
+                    GetTree(tracked.isFixed).DestroyProxy(tracked.proxyId);
+                    Insert(entity, drawn);
+                } else if (!(tracked.bounds == drawn.bounds)) {
+                    tracked.bounds = drawn.bounds;
+                    GetTree(tracked.isFixed).MoveProxy(tracked.proxyId, tracked.bounds);
+                }
+                tracked.isDirty = false;
+            }
+            tracked.frameSeen = frame;
+        }
+        RemoveUnseen();
+    }
+
+    // has the next Update ask for the entity's bounds again, to be called when something other than
+    // a rigid body changes where it's drawn (a label's text or position, a sprite's scale or rotation)
+    void Invalidate(Entity entity) {
+        const int id = entity.GetId();
+        if (id < static_cast<int>(trackedOfId.size()) && trackedOfId[id].entity == entity) {
+            trackedOfId[id].isDirty = true;
+        }
+    }
+
+    // calls func(entity) for each indexed entity drawn (even partly) on camera, in no particular order
+    template <typename TFunc>
+    void Query(const SDL_Rect& camera, TFunc&& func) const {
+        const AABB world = {static_cast<float>(camera.x), static_cast<float>(camera.y), static_cast<float>(camera.x + camera.w), static_cast<float>(camera.y + camera.h)};
+        const AABB screen = {0.0f, 0.0f, static_cast<float>(camera.w), static_cast<float>(camera.h)};
+        QueryTree(worldTree, world, func);
+        QueryTree(screenTree, screen, func);
+    }
+
+    size_t GetCount() const {return trackedIds.size();}
+
+private:
+    struct Tracked {
+        Entity entity = Entity(-1);
+        int proxyId = DynamicAABBTree::NULL_NODE;
+        uint32_t frameSeen = 0;
+        bool isFixed = false;
+        // getBounds must be called again on the next Update
+        bool isDirty = false;
+        // exact bounds, the tree holds fattened ones
+        AABB bounds = {};
+    };
+
+    DynamicAABBTree& GetTree(bool isFixed) {return isFixed ? screenTree : worldTree;}
+
+    template <typename TFunc>
+    void QueryTree(const DynamicAABBTree& tree, const AABB& area, TFunc& func) const {
+        tree.Query(area, [this, &tree, &area, &func](int proxyId) {
+            const Tracked& tracked = trackedOfId[tree.GetUserData(proxyId)];
+            if (tracked.bounds.Overlaps(area)) {
+                func(tracked.entity);
+            }
+            return true;
+        });
+    }
+
+    void Insert(Entity entity, const RenderBounds& drawn);
+    void RemoveUnseen();
+
+    DynamicAABBTree worldTree;
+    DynamicAABBTree screenTree;
+
+    // [Vector index = entity id]
+    std::vector<Tracked> trackedOfId;
+    std::vector<int> trackedIds;
+    uint32_t frame = 0;
+};
+
+#endif
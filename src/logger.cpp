@@ -9,35 +9,58 @@
 
 // -----------------------------------------------------------------------------
 // logger.cpp
-// implementation file for logger class
+// implementation file for the engine logging layer
 // -----------------------------------------------------------------------------
 #include "headers/logger.h"
-#include <iostream>
-#include <string>
-#include <chrono>
-#include <ctime>
-
-std::vector<LogEntry> Logger::messages;
-
-std::string CurrentDateTimeToString() {
-    std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
-    std::string output(30, '\0');
-    std::strftime(&output[0], output.size(), "%d-%b-%Y %H:%M:%S", std::localtime(&now));
-    return output;
-}
+#include <spdlog/async.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
+
+std::shared_ptr<spdlog::logger> Logger::loggers[static_cast<int>(LogCategory::Count)];
+
+static const char* CATEGORY_NAMES[static_cast<int>(LogCategory::Count)] = {
+    "engine",
+    "ecs",
+    "assets",
+    "events",
+    "collision",
+    "damage"
+};
+
+// queued messages, and the number of background threads writing them out
+static constexpr size_t ASYNC_QUEUE_SIZE = 8192;
+static constexpr size_t ASYNC_THREADS = 1;
 
-void Logger::Log(const std::string& message) {
-    LogEntry logEntry;
-    logEntry.type = LOG_INFO;
-    logEntry.message = "LOG: [" + CurrentDateTimeToString() + "]: " + message;
-    std::cout << "\x1B[32m" << logEntry.message << "\033[0m" << std::endl;
-    messages.push_back(logEntry);
+void Logger::Initialize(bool async) {
+    // every category writes to the same console sink
+    auto sink = std::make_shared<spdlog::sinks::stdout_color_sink_mt>();
+    if (async) {
+        spdlog::init_thread_pool(ASYNC_QUEUE_SIZE, ASYNC_THREADS);
+    }
+
+    for (int category = 0; category < static_cast<int>(LogCategory::Count); category++) {
+        std::shared_ptr<spdlog::logger> logger;
+        if (async) {
+            logger = std::make_shared<spdlog::async_logger>(CATEGORY_NAMES[category], sink, spdlog::thread_pool(), spdlog::async_overflow_policy::overrun_oldest);
+        }
+        else {
+            logger = std::make_shared<spdlog::logger>(CATEGORY_NAMES[category], sink);
+        }
+
+        // the runtime level follows the compile-time one, so enabled calls are never filtered twice
+        logger->set_level(static_cast<spdlog::level::level_enum>(ENGINE_LOG_LEVEL));
+        logger->flush_on(spdlog::level::err);
+        loggers[category] = logger;
+    }
 }
 
-void Logger::Err(const std::string& message) {
-    LogEntry logEntry;
-    logEntry.type = LOG_ERROR;
-    logEntry.message = "ERR: [" + CurrentDateTimeToString() + "]: " + message;
-    messages.push_back(logEntry);
-    std::cerr << "\x1B[91m"<< logEntry.message << "\033[0m" << std::endl;
+void Logger::Shutdown() {
+    for (auto& logger : loggers) {
+        if (logger) {
+            logger->flush();
+        }
+        logger.reset();
+    }
+
+    // releasing the thread pool joins its thread once the queued messages are written
+    spdlog::details::registry::instance().set_tp(nullptr);
 }
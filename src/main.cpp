@@ -12,13 +12,21 @@
 // main program
 // -----------------------------------------------------------------------------
 #include "headers/game.h"
+#include "headers/logger.h"
 
 int main(int argc, char* argv[]) {
-    Game game;
+    Logger::Initialize();
 
-    game.Initialize();
-    game.Run();
-    game.Destroy();
+    // scoped so the game is torn down (and logs it) before the logger shuts down
+    {
+        Game game;
+
+        game.Initialize();
+        game.Run();
+        game.Destroy();
+    }
+
+    Logger::Shutdown();
 
     return 0;
 }
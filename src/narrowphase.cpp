@@ -0,0 +1,139 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// narrowphase.cpp
+// implementation file for the batched AABB overlap tests (AVX2, SSE or scalar,
+// picked at compile time like the signature matching, see ECS_SIMD in the Makefile)
+// and the swept AABB test of the continuous colliders
+// -----------------------------------------------------------------------------
+#include "headers/narrowphase.h"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+static_assert(sizeof(ColliderPair) == 2 * sizeof(int), "the SIMD paths load pairs as consecutive (a, b) ints");
+
+// appends the pairs flagged in mask (bit i = pairs[i]) to overlaps
+static size_t CompactPairs(uint32_t mask, const ColliderPair* pairs, ColliderPair* overlaps) {
+    size_t count = 0;
+    while (mask != 0) {
+        overlaps[count++] = pairs[std::countr_zero(mask)];
+        mask &= mask - 1;
+    }
+    return count;
+}
+
+size_t FindOverlappingPairs(const ColliderBounds& bounds, std::span<const ColliderPair> pairs, ColliderPair* overlaps) {
+    const float* minX = bounds.minX.data();
+    const float* minY = bounds.minY.data();
+    const float* maxX = bounds.maxX.data();
+    const float* maxY = bounds.maxY.data();
+
+    size_t overlapCount = 0;
+    size_t i = 0;
+
+#if defined(__AVX2__)
+    // 8 pairs at a time: split the (a, b) indices in two vectors, gather the bounds, compare
+    for (; i + 8 <= pairs.size(); i += 8) {
+        const int* indices = reinterpret_cast<const int*>(pairs.data() + i);
+        const __m256 low = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices)));
+        const __m256 high = _mm256_castsi256_ps(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + 8)));
+
+        // the shuffle leaves the indices in the order 0 1 4 5 | 2 3 6 7, the permute fixes it
+        const __m256i a = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(2, 0, 2, 0))), _MM_SHUFFLE(3, 1, 2, 0));
+        const __m256i b = _mm256_permute4x64_epi64(_mm256_castps_si256(_mm256_shuffle_ps(low, high, _MM_SHUFFLE(3, 1, 3, 1))), _MM_SHUFFLE(3, 1, 2, 0));
+
+        const __m256 overlapX = _mm256_and_ps(
+            _mm256_cmp_ps(_mm256_i32gather_ps(minX, a, 4), _mm256_i32gather_ps(maxX, b, 4), _CMP_LT_OQ),
+            _mm256_cmp_ps(_mm256_i32gather_ps(maxX, a, 4), _mm256_i32gather_ps(minX, b, 4), _CMP_GT_OQ)
+        );
+        const __m256 overlapY = _mm256_and_ps(
+            _mm256_cmp_ps(_mm256_i32gather_ps(minY, a, 4), _mm256_i32gather_ps(maxY, b, 4), _CMP_LT_OQ),
+            _mm256_cmp_ps(_mm256_i32gather_ps(maxY, a, 4), _mm256_i32gather_ps(minY, b, 4), _CMP_GT_OQ)
+        );
+        const uint32_t mask = static_cast<uint32_t>(_mm256_movemask_ps(_mm256_and_ps(overlapX, overlapY)));
+        overlapCount += CompactPairs(mask, pairs.data() + i, overlaps + overlapCount);
+    }
+#elif defined(__SSE2__)
+    // 4 pairs at a time (SSE has no gather, the bounds are loaded one by one)
+    for (; i + 4 <= pairs.size(); i += 4) {
+        const ColliderPair* p = pairs.data() + i;
+        auto load = [p](const float* values, bool first) {
+            return first ?
+                _mm_setr_ps(values[p[0].a], values[p[1].a], values[p[2].a], values[p[3].a]) :
+                _mm_setr_ps(values[p[0].b], values[p[1].b], values[p[2].b], values[p[3].b]);
+        };
+
+        const __m128 overlapX = _mm_and_ps(_mm_cmplt_ps(load(minX, true), load(maxX, false)), _mm_cmpgt_ps(load(maxX, true), load(minX, false)));
+        const __m128 overlapY = _mm_and_ps(_mm_cmplt_ps(load(minY, true), load(maxY, false)), _mm_cmpgt_ps(load(maxY, true), load(minY, false)));
+        const uint32_t mask = static_cast<uint32_t>(_mm_movemask_ps(_mm_and_ps(overlapX, overlapY)));
+        overlapCount += CompactPairs(mask, p, overlaps + overlapCount);
+    }
+#endif
+
+    // the remaining pairs (all of them without SIMD), without branches: most candidates don't
+    // overlap, in no predictable pattern, so the pair is always written and only kept by the count
+    for (; i < pairs.size(); i++) {
+        const int a = pairs[i].a;
+        const int b = pairs[i].b;
+        const bool overlapping = (minX[a] < maxX[b]) & (maxX[a] > minX[b]) & (minY[a] < maxY[b]) & (maxY[a] > minY[b]);
+        overlaps[overlapCount] = pairs[i];
+        overlapCount += overlapping;
+    }
+    return overlapCount;
+}
+
+// [enter, exit]: the times at which the moving interval [min, max] + displacement * t starts
+// and stops strictly overlapping the still interval [otherMin, otherMax]
+static void SweepInterval(double min, double max, double displacement, double otherMin, double otherMax, double& enter, double& exit) {
+    if (displacement > 0.0) {
+        enter = (otherMin - max) / displacement;
+        exit = (otherMax - min) / displacement;
+    } else if (displacement < 0.0) {
+        enter = (otherMax - min) / displacement;
+        exit = (otherMin - max) / displacement;
+    } else if (min < otherMax && max > otherMin) {
+        enter = -std::numeric_limits<double>::infinity();
+        exit = std::numeric_limits<double>::infinity();
+    } else {
+        enter = std::numeric_limits<double>::infinity();
+        exit = -std::numeric_limits<double>::infinity();
+    }
+}
+
+bool FindTimeOfImpact(const AABB& startA, const AABB& endA, const AABB& startB, const AABB& endB, float& timeOfImpact) {
+    // b is still in the frame of reference of a box moving by the difference of their displacements
+    const double displacementX = (static_cast<double>(endA.minX) - startA.minX) - (static_cast<double>(endB.minX) - startB.minX);
+    const double displacementY = (static_cast<double>(endA.minY) - startA.minY) - (static_cast<double>(endB.minY) - startB.minY);
+
+    double enterX, exitX, enterY, exitY;
+    SweepInterval(startA.minX, startA.maxX, displacementX, startB.minX, startB.maxX, enterX, exitX);
+    SweepInterval(startA.minY, startA.maxY, displacementY, startB.minY, startB.maxY, enterY, exitY);
+    const double enter = std::max(enterX, enterY);
+    const double exit = std::min(exitX, exitY);
+    if (enter < exit && enter < 1.0 && exit > 0.0) {
+        timeOfImpact = static_cast<float>(std::max(enter, 0.0));
+        return true;
+    }
+
+    // the end of the frame is tested like the discrete colliders (rounding can't lose those hits)
+    if (endA.Overlaps(endB)) {
+        timeOfImpact = 1.0f;
+        return true;
+    }
+    return false;
+}
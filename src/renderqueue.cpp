@@ -0,0 +1,79 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// renderqueue.cpp
+// implementation file for the Render Queue
+// -----------------------------------------------------------------------------
+#include "headers/renderqueue.h"
+#include "headers/spritecomponent.h"
+#include <algorithm>
+#include <iterator>
+
+uint64_t RenderQueue::MakeKey(int zIndex, int textureHandle, uint32_t sequence) {
+    // z-index biased so negative ones sort first, sprites without a texture last in their z-index
+    const auto z = static_cast<uint64_t>(std::clamp(zIndex + 0x8000, 0, 0xFFFF));
+    const auto texture = static_cast<uint64_t>(textureHandle >= 0 ? std::min(textureHandle, 0xFFFE) : 0xFFFF);
+    return (z << 48) | (texture << 32) | sequence;
+}
+
+void RenderQueue::Update(std::span<const Entity> entities, const AssetStore& assetStore) {
+    frame++;
+    changedItems.clear();
+
+    // the unchanged items are marked as seen, the new and changed ones are (re-)keyed on the side
+    for (const auto& entity : entities) {
+        const int id = entity.GetId();
+        if (id >= static_cast<int>(itemOfId.size())) {
+            itemOfId.resize(id + 1, -1);
+            frameSeen.resize(id + 1, 0);
+        }
+
+        const auto& sprite = entity.GetComponent<SpriteComponent>();
+        const int index = itemOfId[id];
+        if (index != -1 && index < static_cast<int>(items.size()) && items[index].entity == entity) {
+            const Item& item = items[index];
+            if (item.zIndex == sprite.zIndex && item.assetId == sprite.assetId) {
+                frameSeen[id] = frame;
+                continue;
+            }
+            // keeps its sequence, so it still comes after the sprites queued before it
+            const int textureHandle = assetStore.GetTextureHandle(sprite.assetId);
+            changedItems.push_back({entity, MakeKey(sprite.zIndex, textureHandle, static_cast<uint32_t>(item.key)), textureHandle, sprite.zIndex, sprite.assetId});
+        } else {
+            const int textureHandle = assetStore.GetTextureHandle(sprite.assetId);
+            changedItems.push_back({entity, MakeKey(sprite.zIndex, textureHandle, nextSequence++), textureHandle, sprite.zIndex, sprite.assetId});
+        }
+    }
+
+    // drop the gone and changed items, the others are still in order
+    std::erase_if(items, [this](const Item& item) {
+        return frameSeen[item.entity.GetId()] != frame;
+    });
+
+    // sort the few changed items and merge them back in
+    if (!changedItems.empty()) {
+        const auto byKey = [](const Item& a, const Item& b) { return a.key < b.key; };
+        std::sort(changedItems.begin(), changedItems.end(), byKey);
+        mergedItems.clear();
+        mergedItems.reserve(items.size() + changedItems.size());
+        std::merge(std::make_move_iterator(items.begin()), std::make_move_iterator(items.end()),
+                   std::make_move_iterator(changedItems.begin()), std::make_move_iterator(changedItems.end()),
+                   std::back_inserter(mergedItems), byKey);
+        items.swap(mergedItems);
+    }
+
+    textureSwitches = 0;
+    for (int index = 0; index < static_cast<int>(items.size()); index++) {
+        itemOfId[items[index].entity.GetId()] = index;
+        if (index == 0 || items[index].textureHandle != items[index - 1].textureHandle) {
+            textureSwitches++;
+        }
+    }
+}
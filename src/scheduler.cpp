@@ -0,0 +1,81 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// scheduler.cpp
+// implementation file for the system scheduler
+// -----------------------------------------------------------------------------
+#include "headers/scheduler.h"
+
+void SystemScheduler::Add(const System& system, std::function<void()> update) {
+    Task task;
+    task.reads = system.GetReadSignature();
+    task.writes = system.GetWriteSignature();
+    task.isExclusive = system.IsExclusive();
+    task.update = std::move(update);
+    tasks.push_back(std::move(task));
+}
+
+bool SystemScheduler::Conflicts(const Task& a, const Task& b) {
+    if (a.isExclusive || b.isExclusive) {
+        return true;
+    }
+
+    // a write conflicts with any other access of the same component, reads can be shared
+    return !(a.writes & (b.reads | b.writes)).None() || !(b.writes & a.reads).None();
+}
+
+void SystemScheduler::BuildGraph() {
+    for (size_t later = 0; later < tasks.size(); later++) {
+        for (size_t earlier = 0; earlier < later; earlier++) {
+            if (Conflicts(tasks[earlier], tasks[later])) {
+                tasks[earlier].successors.push_back(static_cast<int>(later));
+                tasks[later].predecessorCount++;
+            }
+        }
+    }
+}
+
+void SystemScheduler::Run() {
+    if (tasks.empty()) {
+        return;
+    }
+
+    BuildGraph();
+
+    predecessorsLeft = std::make_unique<std::atomic<int>[]>(tasks.size());
+    for (size_t i = 0; i < tasks.size(); i++) {
+        predecessorsLeft[i].store(tasks[i].predecessorCount, std::memory_order_relaxed);
+    }
+    tasksLeft.store(static_cast<int>(tasks.size()), std::memory_order_relaxed);
+
+    // start every update that doesn't wait on another, the rest are started as they get unblocked
+    for (size_t i = 0; i < tasks.size(); i++) {
+        if (tasks[i].predecessorCount == 0) {
+            threadPool.Submit([this, i]() { RunTask(static_cast<int>(i)); });
+        }
+    }
+
+    // the calling thread helps running the updates until the whole frame is done
+    threadPool.WaitUntil([this]() {return tasksLeft.load(std::memory_order_acquire) == 0;});
+
+    tasks.clear();
+}
+
+void SystemScheduler::RunTask(int index) {
+    Task& task = tasks[index];
+    task.update();
+
+    for (const int successor : task.successors) {
+        if (predecessorsLeft[successor].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            threadPool.Submit([this, successor]() { RunTask(successor); });
+        }
+    }
+    tasksLeft.fetch_sub(1, std::memory_order_release);
+}
@@ -0,0 +1,128 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// spatialhash.cpp
+// implementation file for the uniform grid broadphase
+// -----------------------------------------------------------------------------
+#include "headers/spatialhash.h"
+#include <algorithm>
+#include <bit>
+
+SpatialHash::SpatialHash(float cellSize) {
+    SetCellSize(cellSize);
+}
+
+void SpatialHash::SetCellSize(float cellSize) {
+    this->cellSize = cellSize;
+    inverseCellSize = 1.0f / cellSize;
+}
+
+static uint32_t HashCell(int cellX, int cellY) {
+    return static_cast<uint32_t>(cellX) * 73856093u ^ static_cast<uint32_t>(cellY) * 19349663u;
+}
+
+void SpatialHash::FindPairs(std::span<const int>, std::span<const AABB> bounds, std::span<const CollisionFilter> filters, std::vector<ColliderPair>& pairs, ThreadPool& threadPool) {
+    pairs.clear();
+    entries.clear();
+
+    // insert every box in each cell it covers
+    for (int i = 0; i < static_cast<int>(bounds.size()); i++) {
+        const AABB& box = bounds[i];
+        const int lastCellX = CellOf(box.maxX);
+        const int lastCellY = CellOf(box.maxY);
+        for (int cellY = CellOf(box.minY); cellY <= lastCellY; cellY++) {
+            for (int cellX = CellOf(box.minX); cellX <= lastCellX; cellX++) {
+                entries.push_back({cellX, cellY, i, 0});
+            }
+        }
+    }
+    colliderBounds.assign(bounds.begin(), bounds.end());
+
+    // counting sort into about two buckets per entry (stable, so each bucket stays in index order)
+    // (built even without pairs to find, the queries use it)
+    const uint32_t bucketCount = std::bit_ceil(static_cast<uint32_t>(std::max<size_t>(entries.size() * 2, 1)));
+    bucketMask = bucketCount - 1;
+    bucketStarts.assign(bucketCount + 1, 0);
+    for (auto& entry : entries) {
+        entry.bucket = HashCell(entry.cellX, entry.cellY) & bucketMask;
+        bucketStarts[entry.bucket + 1]++;
+    }
+    for (uint32_t bucket = 0; bucket < bucketCount; bucket++) {
+        bucketStarts[bucket + 1] += bucketStarts[bucket];
+    }
+    sortedEntries.resize(entries.size());
+    for (const auto& entry : entries) {
+        sortedEntries[bucketStarts[entry.bucket]++] = entry;
+    }
+
+    // pair up the boxes of each cell (a bucket may mix a few cells); a pair sharing several
+    // cells is only kept in the cell holding the min corner of their overlap, so an
+    // overlapping pair comes out once (chunks of buckets in parallel)
+    pairBuffers.Reset((bucketCount + BROADPHASE_BUCKETS_PER_CHUNK - 1) / BROADPHASE_BUCKETS_PER_CHUNK);
+    threadPool.ParallelFor(0, bucketCount, BROADPHASE_BUCKETS_PER_CHUNK, [&](size_t chunkBegin, size_t chunkEnd) {
+        auto& chunkPairs = pairBuffers.GetChunk(chunkBegin / BROADPHASE_BUCKETS_PER_CHUNK);
+        size_t bucketBegin = chunkBegin == 0 ? 0 : bucketStarts[chunkBegin - 1];
+        for (size_t bucket = chunkBegin; bucket < chunkEnd; bucket++) {
+            const size_t bucketEnd = bucketStarts[bucket];
+            for (size_t first = bucketBegin; first < bucketEnd; first++) {
+                const CellEntry& a = sortedEntries[first];
+                for (size_t second = first + 1; second < bucketEnd; second++) {
+                    const CellEntry& b = sortedEntries[second];
+                    if (a.cellX != b.cellX || a.cellY != b.cellY || !filters[a.index].CanCollide(filters[b.index])) {
+                        continue;
+                    }
+                    const float overlapMinX = std::max(bounds[a.index].minX, bounds[b.index].minX);
+                    const float overlapMinY = std::max(bounds[a.index].minY, bounds[b.index].minY);
+                    if (CellOf(overlapMinX) == a.cellX && CellOf(overlapMinY) == a.cellY) {
+                        chunkPairs.push_back({a.index, b.index});
+                    }
+                }
+            }
+            bucketBegin = bucketEnd;
+        }
+        std::sort(chunkPairs.begin(), chunkPairs.end());
+    });
+
+    // same order as testing every pair in index order
+    pairBuffers.Merge(pairs, threadPool);
+}
+
+void SpatialHash::QueryArea(const AABB& area, ColliderVisitor visit, void* context) const {
+    // a large area (e.g. a long ray) covers more cells than there are colliders, checking them all is faster
+    const double columns = std::floor(area.maxX * inverseCellSize) - std::floor(area.minX * inverseCellSize) + 1.0;
+    const double rows = std::floor(area.maxY * inverseCellSize) - std::floor(area.minY * inverseCellSize) + 1.0;
+    if (columns * rows > static_cast<double>(colliderBounds.size())) {
+        for (int index = 0; index < static_cast<int>(colliderBounds.size()); index++) {
+            if (colliderBounds[index].Overlaps(area)) {
+                visit(context, index);
+            }
+        }
+        return;
+    }
+
+    const int lastCellX = CellOf(area.maxX);
+    const int lastCellY = CellOf(area.maxY);
+    for (int cellY = CellOf(area.minY); cellY <= lastCellY; cellY++) {
+        for (int cellX = CellOf(area.minX); cellX <= lastCellX; cellX++) {
+            const uint32_t bucket = HashCell(cellX, cellY) & bucketMask;
+            const size_t bucketBegin = bucket == 0 ? 0 : bucketStarts[bucket - 1];
+            for (size_t entry = bucketBegin; entry < bucketStarts[bucket]; entry++) {
+                const CellEntry& candidate = sortedEntries[entry];
+                if (candidate.cellX != cellX || candidate.cellY != cellY) {
+                    continue;
+                }
+                const AABB& box = colliderBounds[candidate.index];
+                if (box.Overlaps(area) && CellOf(std::max(box.minX, area.minX)) == cellX && CellOf(std::max(box.minY, area.minY)) == cellY) {
+                    visit(context, candidate.index);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,115 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// threadpool.cpp
+// implementation file for the work-stealing thread pool
+// -----------------------------------------------------------------------------
+#include "headers/threadpool.h"
+
+// index of the pool worker running on this thread (-1 for threads outside the pool)
+static thread_local int currentWorkerIndex = -1;
+static thread_local const ThreadPool* currentPool = nullptr;
+
+ThreadPool::ThreadPool(unsigned int threadCount) {
+    for (unsigned int i = 0; i <= threadCount; i++) {
+        queues.push_back(std::make_unique<TaskQueue>());
+    }
+    for (unsigned int i = 0; i < threadCount; i++) {
+        workers.emplace_back(&ThreadPool::WorkerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+unsigned int ThreadPool::DefaultThreadCount() {
+    const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+    return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+}
+
+void ThreadPool::Submit(std::function<void()> task) {
+    // workers keep their own tasks close, everyone else uses the shared queue
+    const bool isOwnWorker = currentPool == this && currentWorkerIndex >= 0;
+    TaskQueue& queue = *queues[isOwnWorker ? currentWorkerIndex : queues.size() - 1];
+    {
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    queuedTasks.fetch_add(1, std::memory_order_release);
+
+    // the lock pairs with the sleeping worker's predicate check, so the wake up can't be missed
+    { std::lock_guard<std::mutex> lock(sleepMutex); }
+    wakeUp.notify_one();
+}
+
+bool ThreadPool::PopTask(std::function<void()>& task) {
+    const bool isOwnWorker = currentPool == this && currentWorkerIndex >= 0;
+    const size_t queueCount = queues.size();
+
+    // newest task of our own queue first (its data is most likely still in cache)
+    if (isOwnWorker) {
+        TaskQueue& queue = *queues[currentWorkerIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+            return true;
+        }
+    }
+
+    // then the oldest task of the shared queue, then steal the oldest task of another worker
+    const size_t sharedIndex = queueCount - 1;
+    const size_t firstVictim = isOwnWorker ? currentWorkerIndex + 1 : 0;
+    for (size_t i = 0; i < queueCount; i++) {
+        TaskQueue& queue = *queues[i == 0 ? sharedIndex : (firstVictim + i - 1) % sharedIndex];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (!queue.tasks.empty()) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ThreadPool::TryRunTask() {
+    std::function<void()> task;
+    if (!PopTask(task)) {
+        return false;
+    }
+    queuedTasks.fetch_sub(1, std::memory_order_relaxed);
+    task();
+    return true;
+}
+
+void ThreadPool::WorkerLoop(unsigned int index) {
+    currentWorkerIndex = static_cast<int>(index);
+    currentPool = this;
+
+    while (true) {
+        if (TryRunTask()) {
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wakeUp.wait(lock, [this]() {return stopping || queuedTasks.load(std::memory_order_acquire) > 0;});
+        if (stopping) {
+            return;
+        }
+    }
+}
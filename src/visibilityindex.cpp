@@ -0,0 +1,35 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// visibilityindex.cpp
+// implementation file for the Visibility Index
+// -----------------------------------------------------------------------------
+#include "headers/visibilityindex.h"
+
+void VisibilityIndex::Insert(Entity entity, const RenderBounds& drawn) {
+    Tracked& tracked = trackedOfId[entity.GetId()];
+    tracked.entity = entity;
+    tracked.isFixed = drawn.isFixed;
+    tracked.isDirty = false;
+    tracked.bounds = drawn.bounds;
+    tracked.proxyId = GetTree(drawn.isFixed).CreateProxy(drawn.bounds, entity.GetId());
+}
+
+void VisibilityIndex::RemoveUnseen() {
+    std::erase_if(trackedIds, [this](int id) {
+        Tracked& tracked = trackedOfId[id];
+        if (tracked.frameSeen == frame) {
+            return false;
+        }
+        GetTree(tracked.isFixed).DestroyProxy(tracked.proxyId);
+        tracked.proxyId = DynamicAABBTree::NULL_NODE;
+        return true;
+    });
+}
@@ -0,0 +1,115 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// broadphase_parallel_test.cpp
+// every broadphase backend run with thread pools of 0, 1 and several workers:
+// the candidate pairs must be exactly the ones of the single-threaded path,
+// in the same order, on every frame
+// -----------------------------------------------------------------------------
+#include "testing.h"
+#include "broadphasescenes.h"
+#include "broadphase.h"
+#include <cstdio>
+#include <memory>
+#include <random>
+#include <vector>
+
+static constexpr BroadphaseType BACKENDS[] = {
+    BroadphaseType::BruteForce,
+    BroadphaseType::SpatialHash,
+    BroadphaseType::DynamicTree,
+    BroadphaseType::SweepAndPrune
+};
+
+// compared with the pool without workers, which runs the whole search as one chunk
+static constexpr unsigned int WORKER_COUNTS[] = {1, 3, 7};
+
+// a swarm of boxes big enough to be split into many chunks (buckets, rows, intervals)
+static SceneFrame RandomFrame(std::mt19937& random, int count) {
+    std::uniform_real_distribution<float> position(0.0f, 3000.0f);
+    std::uniform_real_distribution<float> size(1.0f, 80.0f);
+    std::uniform_int_distribution<int> layer(0, static_cast<int>(CollisionLayer::Count) - 1);
+
+    SceneFrame frame;
+    for (int i = 0; i < count; i++) {
+        const float x = position(random);
+        const float y = position(random);
+        frame.ids.push_back(i);
+        frame.bounds.push_back({x, y, x + size(random), y + size(random)});
+        frame.layers.push_back(static_cast<CollisionLayer>(layer(random)));
+    }
+    return frame;
+}
+
+// replays the frames through one broadphase per pool, returns the frames whose pairs differ
+// from the single-threaded ones (the broadphases are kept across frames, like in the game)
+static size_t CountMismatches(BroadphaseType type, const std::vector<SceneFrame>& frames, const CollisionLayerMatrix& layers,
+    ThreadPool& serialPool, std::vector<std::unique_ptr<ThreadPool>>& threadPools) {
+    BroadphaseSettings settings;
+    settings.type = type;
+    const std::unique_ptr<IBroadphase> serial = CreateBroadphase(settings);
+    std::vector<std::unique_ptr<IBroadphase>> parallel;
+    for (size_t i = 0; i < threadPools.size(); i++) {
+        parallel.push_back(CreateBroadphase(settings));
+    }
+
+    size_t mismatches = 0;
+    std::vector<ColliderPair> expected;
+    std::vector<ColliderPair> pairs;
+    for (const auto& frame : frames) {
+        const std::vector<CollisionFilter> filters = GetFilters(frame, layers);
+        serial->FindPairs(frame.ids, frame.bounds, filters, expected, serialPool);
+        for (size_t i = 0; i < threadPools.size(); i++) {
+            parallel[i]->FindPairs(frame.ids, frame.bounds, filters, pairs, *threadPools[i]);
+            mismatches += pairs != expected;
+        }
+    }
+    return mismatches;
+}
+
+int main() {
+    ThreadPool serialPool(0);
+    std::vector<std::unique_ptr<ThreadPool>> threadPools;
+    for (const unsigned int workers : WORKER_COUNTS) {
+        threadPools.push_back(std::make_unique<ThreadPool>(workers));
+    }
+    const CollisionLayerMatrix allLayers;
+    const CollisionLayerMatrix gameLayers = GameLayerMatrix();
+
+    // random frames, from empty to a few thousand colliders
+    std::mt19937 random(2024);
+    std::vector<SceneFrame> randomFrames;
+    for (const int count : {0, 1, 2, 255, 256, 257, 1000, 4000}) {
+        for (int repetition = 0; repetition < 3; repetition++) {
+            randomFrames.push_back(RandomFrame(random, count));
+        }
+    }
+    for (const auto type : BACKENDS) {
+        const size_t mismatches = CountMismatches(type, randomFrames, allLayers, serialPool, threadPools)
+            + CountMismatches(type, randomFrames, gameLayers, serialPool, threadPools);
+        CHECK(mismatches == 0);
+        std::printf("random frames, %s: %zu mismatches\n", CreateBroadphase({type})->GetName(), mismatches);
+    }
+
+    // the recorded scenes (brute force is left out of the bigger ones, it adds nothing but time)
+    for (const auto& scene : RECORDED_SCENES) {
+        const std::vector<SceneFrame> recording = RecordScene(scene);
+        for (const auto type : BACKENDS) {
+            if (type == BroadphaseType::BruteForce && recording.back().ids.size() > 1000) {
+                continue;
+            }
+            const size_t mismatches = CountMismatches(type, recording, gameLayers, serialPool, threadPools);
+            CHECK(mismatches == 0);
+            std::printf("%s, %s: %zu frames, %zu mismatches\n", scene.name, CreateBroadphase({type})->GetName(), recording.size(), mismatches);
+        }
+    }
+
+    return TestResult("broadphase_parallel_test");
+}
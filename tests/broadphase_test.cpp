@@ -0,0 +1,136 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// broadphase_test.cpp
+// every broadphase backend against the brute force one, on random and recorded
+// scenes: once the narrowphase drops the candidates that don't overlap, the
+// pair lists must be identical
+// -----------------------------------------------------------------------------
+#include "testing.h"
+#include "broadphasescenes.h"
+#include "broadphase.h"
+#include "spatialhash.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// candidates must be sorted by (a, b), each pair once, with a < b
+static bool IsSortedPairList(const std::vector<ColliderPair>& pairs) {
+    for (size_t i = 0; i < pairs.size(); i++) {
+        if (pairs[i].a >= pairs[i].b || (i > 0 && !(pairs[i - 1] < pairs[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// boxes of every kind the hash has to get right: tiny and huge ones, points, negative
+// coordinates, grid-aligned tiles that only touch, and exact duplicates
+static SceneFrame RandomFrame(std::mt19937& random, int count) {
+    std::uniform_real_distribution<float> position(-500.0f, 1500.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> layer(0, static_cast<int>(CollisionLayer::Count) - 1);
+
+    SceneFrame frame;
+    for (int i = 0; i < count; i++) {
+        float x = position(random);
+        float y = position(random);
+        float width = 0.0f;
+        float height = 0.0f;
+        switch (i % 6) {
+            case 0: width = unit(random) * 2.0f; height = unit(random) * 2.0f; break;
+            case 1: case 2: width = 4.0f + unit(random) * 60.0f; height = 4.0f + unit(random) * 60.0f; break;
+            case 3: width = 100.0f + unit(random) * 500.0f; height = 100.0f + unit(random) * 500.0f; break;
+            case 4: x = std::floor(x / 64.0f) * 64.0f; y = std::floor(y / 64.0f) * 64.0f; width = 64.0f; height = 64.0f; break;
+            case 5: break;
+        }
+        if (i > 0 && unit(random) < 0.05f) {
+            frame.bounds.push_back(frame.bounds[random() % frame.bounds.size()]);
+        } else {
+            frame.bounds.push_back({x, y, x + width, y + height});
+        }
+        frame.ids.push_back(i);
+        frame.layers.push_back(static_cast<CollisionLayer>(layer(random)));
+    }
+    return frame;
+}
+
+// compares a backend with brute force on one frame
+static bool SameAsBruteForce(IBroadphase& broadphase, BruteForceBroadphase& bruteForce, const SceneFrame& frame, const CollisionLayerMatrix& layers, ThreadPool& threadPool) {
+    const std::vector<CollisionFilter> filters = GetFilters(frame, layers);
+    std::vector<ColliderPair> expected;
+    std::vector<ColliderPair> candidates;
+    bruteForce.FindPairs(frame.ids, frame.bounds, filters, expected, threadPool);
+    broadphase.FindPairs(frame.ids, frame.bounds, filters, candidates, threadPool);
+    return IsSortedPairList(candidates) && OverlappingPairs(frame.bounds, candidates) == expected;
+}
+
+static constexpr BroadphaseType BACKENDS[] = {
+    BroadphaseType::SpatialHash,
+    BroadphaseType::DynamicTree,
+    BroadphaseType::SweepAndPrune
+};
+
+int main() {
+    ThreadPool threadPool(2);
+    const CollisionLayerMatrix allLayers;
+    const CollisionLayerMatrix gameLayers = GameLayerMatrix();
+
+    // random scenes (the spatial hash at several cell sizes, much smaller and much larger than the boxes)
+    std::mt19937 random(2024);
+    int randomFrames = 0;
+    for (const float cellSize : {8.0f, 64.0f, 256.0f}) {
+        SpatialHash spatialHash(cellSize);
+        BruteForceBroadphase bruteForce;
+        for (const int count : {0, 1, 2, 50, 500, 2000}) {
+            for (int repetition = 0; repetition < 3; repetition++) {
+                const SceneFrame frame = RandomFrame(random, count);
+                CHECK(SameAsBruteForce(spatialHash, bruteForce, frame, allLayers, threadPool));
+                CHECK(SameAsBruteForce(spatialHash, bruteForce, frame, gameLayers, threadPool));
+                randomFrames++;
+            }
+        }
+    }
+    for (const auto type : {BroadphaseType::DynamicTree, BroadphaseType::SweepAndPrune}) {
+        BroadphaseSettings settings;
+        settings.type = type;
+        const std::unique_ptr<IBroadphase> broadphase = CreateBroadphase(settings);
+        BruteForceBroadphase bruteForce;
+        for (const int count : {0, 1, 2, 50, 500, 2000}) {
+            for (int repetition = 0; repetition < 3; repetition++) {
+                const SceneFrame frame = RandomFrame(random, count);
+                CHECK(SameAsBruteForce(*broadphase, bruteForce, frame, allLayers, threadPool));
+                CHECK(SameAsBruteForce(*broadphase, bruteForce, frame, gameLayers, threadPool));
+                randomFrames++;
+            }
+        }
+    }
+    std::printf("random scenes: %d frames compared\n", randomFrames);
+
+    // recorded scenes, every frame replayed through each backend (kept across frames, so the
+    // tree and sweep and prune update their structures as colliders move, come and go)
+    for (const auto& scene : RECORDED_SCENES) {
+        const std::vector<SceneFrame> recording = RecordScene(scene);
+        for (const auto type : BACKENDS) {
+            BroadphaseSettings settings;
+            settings.type = type;
+            const std::unique_ptr<IBroadphase> broadphase = CreateBroadphase(settings);
+            BruteForceBroadphase bruteForce;
+            size_t mismatches = 0;
+            for (const auto& frame : recording) {
+                mismatches += !SameAsBruteForce(*broadphase, bruteForce, frame, gameLayers, threadPool);
+            }
+            CHECK(mismatches == 0);
+            std::printf("%s, %s: %zu frames, %zu mismatches\n", scene.name, broadphase->GetName(), recording.size(), mismatches);
+        }
+    }
+
+    return TestResult("broadphase_test");
+}
@@ -0,0 +1,158 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// broadphasescenes.h
+// collider scenes recorded frame by frame, replayed through the broadphases by
+// the tests and benchmarks so every backend sees exactly the same frames
+// -----------------------------------------------------------------------------
+#ifndef BROADPHASESCENES_H
+#define BROADPHASESCENES_H
+
+#include "aabb.h"
+#include "collisionlayers.h"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <span>
+#include <vector>
+
+// the colliders of one frame, as the collision system hands them to the broadphase
+// (ids are reused once their collider is gone, like entity ids)
+struct SceneFrame {
+    std::vector<int> ids;
+    std::vector<AABB> bounds;
+    std::vector<CollisionLayer> layers;
+};
+
+// the shapes of a level: a grid of static tiles, clusters of moving tanks, and
+// streams of short-lived bullets fired from the middle of the map
+struct SceneSettings {
+    const char* name;
+    int tiles;
+    int tanks;
+    int bullets;
+};
+
+constexpr int SCENE_FRAMES = 300;
+
+constexpr SceneSettings RECORDED_SCENES[] = {
+    {"static tiles", 2000, 20, 100},
+    {"tank clusters", 0, 500, 0},
+    {"bullet streams", 0, 20, 3000},
+    {"mixed", 1000, 200, 2000}
+};
+
+// simulates the scene at 60 fps and records each frame (seeded, the same frames on every run)
+inline std::vector<SceneFrame> RecordScene(const SceneSettings& settings, int frames = SCENE_FRAMES) {
+    struct Body {
+        float x;
+        float y;
+        float velocityX;
+        float velocityY;
+        float size;
+        int id;
+        int framesLeft;     // -1 for the ones that stay
+        CollisionLayer layer;
+    };
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Body> bodies;
+    int nextId = 0;
+    std::vector<int> freeIds;
+    auto newId = [&] {
+        if (freeIds.empty()) {
+            return nextId++;
+        }
+        const int id = freeIds.back();
+        freeIds.pop_back();
+        return id;
+    };
+
+    for (int i = 0; i < settings.tiles; i++) {
+        bodies.push_back({(i % 50) * 64.0f, (i / 50) * 64.0f, 0.0f, 0.0f, 64.0f, newId(), -1, CollisionLayer::Static});
+    }
+    for (int i = 0; i < settings.tanks; i++) {
+        const float clusterX = (i / 10) * 400.0f + 100.0f;
+        const float clusterY = (i / 10) * 250.0f + 100.0f;
+        const CollisionLayer layer = i == 0 ? CollisionLayer::Player : CollisionLayer::Enemy;
+        bodies.push_back({clusterX + unit(random) * 100.0f, clusterY + unit(random) * 100.0f, unit(random) * 20.0f - 10.0f, unit(random) * 20.0f - 10.0f, 32.0f, newId(), -1, layer});
+    }
+
+    std::vector<SceneFrame> recording;
+    recording.reserve(frames);
+    int bulletsAlive = 0;
+    for (int frame = 0; frame < frames; frame++) {
+        for (int i = 0; i < settings.bullets / 60 && bulletsAlive < settings.bullets; i++, bulletsAlive++) {
+            const float angle = unit(random) * 6.2831853f;
+            const CollisionLayer layer = i % 2 ? CollisionLayer::PlayerBullet : CollisionLayer::EnemyBullet;
+            bodies.push_back({1000.0f + 200.0f * std::cos(angle), 800.0f + 200.0f * std::sin(angle), 300.0f * std::cos(angle), 300.0f * std::sin(angle), 4.0f, newId(), 90, layer});
+        }
+
+        for (auto& body : bodies) {
+            body.x += body.velocityX / 60.0f;
+            body.y += body.velocityY / 60.0f;
+            if (body.framesLeft > 0) {
+                body.framesLeft--;
+            }
+        }
+        std::erase_if(bodies, [&](const Body& body) {
+            if (body.framesLeft != 0) {
+                return false;
+            }
+            freeIds.push_back(body.id);
+            bulletsAlive--;
+            return true;
+        });
+
+        SceneFrame& recorded = recording.emplace_back();
+        for (const auto& body : bodies) {
+            recorded.ids.push_back(body.id);
+            recorded.bounds.push_back({body.x, body.y, body.x + body.size, body.y + body.size});
+            recorded.layers.push_back(body.layer);
+        }
+    }
+    return recording;
+}
+
+// the layer matrix the game level uses: bullets only hit the other side and the walls, walls don't hit walls
+inline CollisionLayerMatrix GameLayerMatrix() {
+    CollisionLayerMatrix layers;
+    layers.ClearLayer(CollisionLayer::PlayerBullet);
+    layers.ClearLayer(CollisionLayer::EnemyBullet);
+    layers.SetCollides(CollisionLayer::PlayerBullet, CollisionLayer::Enemy, true);
+    layers.SetCollides(CollisionLayer::PlayerBullet, CollisionLayer::Static, true);
+    layers.SetCollides(CollisionLayer::EnemyBullet, CollisionLayer::Player, true);
+    layers.SetCollides(CollisionLayer::EnemyBullet, CollisionLayer::Static, true);
+    layers.SetCollides(CollisionLayer::Static, CollisionLayer::Static, false);
+    return layers;
+}
+
+inline std::vector<CollisionFilter> GetFilters(const SceneFrame& frame, const CollisionLayerMatrix& layers) {
+    std::vector<CollisionFilter> filters;
+    filters.reserve(frame.layers.size());
+    for (const auto layer : frame.layers) {
+        filters.push_back(layers.GetFilter(layer));
+    }
+    return filters;
+}
+
+// the candidates the narrowphase would keep
+inline std::vector<ColliderPair> OverlappingPairs(std::span<const AABB> bounds, std::span<const ColliderPair> candidates) {
+    std::vector<ColliderPair> overlapping;
+    for (const auto& pair : candidates) {
+        if (bounds[pair.a].Overlaps(bounds[pair.b])) {
+            overlapping.push_back(pair);
+        }
+    }
+    return overlapping;
+}
+
+#endif
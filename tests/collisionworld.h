@@ -0,0 +1,63 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// collisionworld.h
+// a collision system with its own registry and event bus, stepped one frame at
+// a time by the tests
+// -----------------------------------------------------------------------------
+#ifndef COLLISIONWORLD_H
+#define COLLISIONWORLD_H
+
+#include "collisionsystem.h"
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+class CollisionWorld {
+public:
+    CollisionWorld(): eventBus(std::make_unique<EventBus>()), threadPool(0) {
+        registry.AddSystem<CollisionSystem>();
+        eventBus->SubscribeToEventBatch<CollisionBeginEvent>([this](std::span<const CollisionBeginEvent> events) {
+            for (const auto& event : events) {
+                begins.push_back({event.a.GetId(), event.b.GetId()});
+            }
+        });
+    }
+
+    CollisionSystem& GetCollisionSystem() {
+        return registry.GetSystem<CollisionSystem>();
+    }
+
+    Entity AddBox(float x, float y, int width, int height, bool isContinuous = false, CollisionLayer layer = CollisionLayer::Default) {
+        Entity entity = registry.CreateEntity();
+        entity.AddComponent<TransformComponent>(glm::vec2(x, y));
+        entity.AddComponent<BoxColliderComponent>(width, height, glm::vec2(0), layer, isContinuous);
+        return entity;
+    }
+
+    // runs the collision system and returns the contacts that began this frame, as (lower id, higher id)
+    std::vector<ColliderPair> Step() {
+        begins.clear();
+        registry.Update();
+        GetCollisionSystem().Update(eventBus, threadPool);
+        eventBus->Flush();
+        std::sort(begins.begin(), begins.end());
+        return begins;
+    }
+
+    Registry registry;
+
+private:
+    std::unique_ptr<EventBus> eventBus;
+    ThreadPool threadPool;
+    std::vector<ColliderPair> begins;
+};
+
+#endif
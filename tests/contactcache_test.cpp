@@ -0,0 +1,142 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// contactcache_test.cpp
+// the begin/stay/end events the contact cache derives from each frame's
+// contacts: a few frames written out by hand (including an id reused with a
+// new generation), then random frames against a set-based reference
+// -----------------------------------------------------------------------------
+#include "testing.h"
+#include "contactcache.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <tuple>
+#include <vector>
+
+enum class ContactEvent { Begin, Stay, End };
+
+// one event as the collision system would enqueue it
+struct ReceivedEvent {
+    ContactEvent type;
+    int a;
+    int generationA;
+    int b;
+    int generationB;
+
+    bool operator ==(const ReceivedEvent& other) const = default;
+};
+
+static std::vector<ReceivedEvent> RunFrame(ContactCache& contactCache, std::vector<Contact> frameContacts) {
+    std::vector<ReceivedEvent> received;
+    auto record = [&received](ContactEvent type) {
+        return [&received, type](const Contact& contact) {
+            received.push_back({type, contact.a.GetId(), contact.a.GetGeneration(), contact.b.GetId(), contact.b.GetGeneration()});
+        };
+    };
+    contactCache.Update(frameContacts, record(ContactEvent::Begin), record(ContactEvent::Stay), record(ContactEvent::End));
+    return received;
+}
+
+// the contacts of a frame by key, with their entities' generations
+using ContactSet = std::map<uint64_t, std::tuple<int, int, int, int>>;
+
+// what the cache must send when going from the previous frame's contacts to the current ones, in key order
+static std::vector<ReceivedEvent> Reference(const ContactSet& previous, const ContactSet& current) {
+    std::vector<ReceivedEvent> expected;
+    auto event = [](ContactEvent type, const std::tuple<int, int, int, int>& contact) {
+        return ReceivedEvent{type, std::get<0>(contact), std::get<1>(contact), std::get<2>(contact), std::get<3>(contact)};
+    };
+    auto oldContact = previous.begin();
+    auto newContact = current.begin();
+    while (oldContact != previous.end() || newContact != current.end()) {
+        if (newContact == current.end() || (oldContact != previous.end() && oldContact->first < newContact->first)) {
+            expected.push_back(event(ContactEvent::End, oldContact->second));
+            oldContact++;
+        } else if (oldContact == previous.end() || newContact->first < oldContact->first) {
+            expected.push_back(event(ContactEvent::Begin, newContact->second));
+            newContact++;
+        } else {
+            if (oldContact->second == newContact->second) {
+                expected.push_back(event(ContactEvent::Stay, newContact->second));
+            } else {
+                expected.push_back(event(ContactEvent::End, oldContact->second));
+                expected.push_back(event(ContactEvent::Begin, newContact->second));
+            }
+            oldContact++;
+            newContact++;
+        }
+    }
+    return expected;
+}
+
+int main() {
+    using enum ContactEvent;
+    ContactCache contactCache;
+
+    // two pairs appear: they begin, in key order whatever order they came in
+    CHECK((RunFrame(contactCache, {Contact(Entity(4), Entity(3)), Contact(Entity(1), Entity(2))}) ==
+        std::vector<ReceivedEvent>{{Begin, 1, 0, 2, 0}, {Begin, 3, 0, 4, 0}}));
+
+    // both persist and a third one appears (given with the higher id first)
+    CHECK((RunFrame(contactCache, {Contact(Entity(5), Entity(1)), Contact(Entity(3), Entity(4)), Contact(Entity(1), Entity(2))}) ==
+        std::vector<ReceivedEvent>{{Stay, 1, 0, 2, 0}, {Begin, 1, 0, 5, 0}, {Stay, 3, 0, 4, 0}}));
+
+    // 3-4 disappears
+    CHECK((RunFrame(contactCache, {Contact(Entity(1), Entity(2)), Contact(Entity(1), Entity(5))}) ==
+        std::vector<ReceivedEvent>{{Stay, 1, 0, 2, 0}, {Stay, 1, 0, 5, 0}, {End, 3, 0, 4, 0}}));
+
+    // entity 2 was destroyed and its id reused: the old pair ends, then the new one begins
+    CHECK((RunFrame(contactCache, {Contact(Entity(1), Entity(2, 1)), Contact(Entity(1), Entity(5))}) ==
+        std::vector<ReceivedEvent>{{End, 1, 0, 2, 0}, {Begin, 1, 0, 2, 1}, {Stay, 1, 0, 5, 0}}));
+    CHECK(contactCache.GetContacts().size() == 2);
+
+    // nothing touches anymore: everything ends, and an empty frame after that sends nothing
+    CHECK((RunFrame(contactCache, {}) == std::vector<ReceivedEvent>{{End, 1, 0, 2, 1}, {End, 1, 0, 5, 0}}));
+    CHECK(RunFrame(contactCache, {}).empty());
+    CHECK(contactCache.GetContacts().empty());
+
+    // random frames: pairs among a few ids come and go, and ids are reused with a new generation
+    std::mt19937 random(2024);
+    constexpr int ENTITIES = 24;
+    std::vector<int> generations(ENTITIES, 0);
+    ContactSet previous;
+    size_t mismatches = 0;
+    size_t events = 0;
+    for (int frame = 0; frame < 2000; frame++) {
+        for (int i = 0; i < 2; i++) {
+            generations[random() % ENTITIES]++;
+        }
+
+        ContactSet current;
+        std::vector<Contact> frameContacts;
+        const int contactCount = static_cast<int>(random() % 40);
+        for (int i = 0; i < contactCount; i++) {
+            const int a = static_cast<int>(random() % ENTITIES);
+            const int b = static_cast<int>(random() % ENTITIES);
+            const Contact contact(Entity(a, generations[a]), Entity(b, generations[b]));
+            if (a == b || current.count(contact.key)) {
+                continue;
+            }
+            current[contact.key] = {contact.a.GetId(), contact.a.GetGeneration(), contact.b.GetId(), contact.b.GetGeneration()};
+            frameContacts.push_back(contact);
+        }
+
+        const std::vector<ReceivedEvent> received = RunFrame(contactCache, frameContacts);
+        mismatches += received != Reference(previous, current);
+        events += received.size();
+        previous = current;
+    }
+    CHECK(mismatches == 0);
+    std::printf("random frames: %zu events, %zu mismatched frames\n", events, mismatches);
+
+    return TestResult("contactcache_test");
+}
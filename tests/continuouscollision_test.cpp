@@ -0,0 +1,108 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// continuouscollision_test.cpp
+// the swept AABB test (FindTimeOfImpact) on boxes set out by hand, then the
+// collision system with continuous colliders: a bullet fast enough to skip
+// through thin walls in a single frame must still hit, and only the first one
+// -----------------------------------------------------------------------------
+#include "testing.h"
+#include "collisionworld.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static bool Near(float value, float expected) {
+    return std::abs(value - expected) < 1e-5f;
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    // a 4x4 bullet crossing 1000 pixels in one frame, through a wall 2 pixels thick at x = 500:
+    // it touches the wall when its right edge reaches 500, after (500 - 4) / 1000 of the frame
+    const AABB bulletStart = {0.0f, 10.0f, 4.0f, 14.0f};
+    const AABB bulletEnd = {1000.0f, 10.0f, 1004.0f, 14.0f};
+    const AABB wall = {500.0f, 0.0f, 502.0f, 100.0f};
+    float timeOfImpact = -1.0f;
+    CHECK(!bulletStart.Overlaps(wall) && !bulletEnd.Overlaps(wall));
+    CHECK(FindTimeOfImpact(bulletStart, bulletEnd, wall, wall, timeOfImpact));
+    CHECK(Near(timeOfImpact, 0.496f));
+
+    // the same with the wall moving towards the bullet by 200: they meet after 496 / 1200 of the frame
+    const AABB wallEnd = {300.0f, 0.0f, 302.0f, 100.0f};
+    CHECK(FindTimeOfImpact(bulletStart, bulletEnd, wall, wallEnd, timeOfImpact));
+    CHECK(Near(timeOfImpact, 496.0f / 1200.0f));
+
+    // diagonally, with the impact decided by the later axis
+    const AABB diagonalEnd = {1000.0f, 1010.0f, 1004.0f, 1014.0f};
+    const AABB block = {500.0f, 700.0f, 900.0f, 800.0f};
+    CHECK(FindTimeOfImpact(bulletStart, diagonalEnd, block, block, timeOfImpact));
+    CHECK(Near(timeOfImpact, (700.0f - 14.0f) / 1000.0f));
+
+    // misses: passing above the wall, moving away from it, and only touching its edge at the end
+    const AABB shortWall = {500.0f, 20.0f, 502.0f, 100.0f};
+    CHECK(!FindTimeOfImpact(bulletStart, bulletEnd, shortWall, shortWall, timeOfImpact));
+    CHECK(!FindTimeOfImpact(bulletEnd, {2000.0f, 10.0f, 2004.0f, 14.0f}, wall, wall, timeOfImpact));
+    CHECK(!FindTimeOfImpact(bulletStart, {496.0f, 10.0f, 500.0f, 14.0f}, wall, wall, timeOfImpact));
+
+    // already overlapping at the start of the frame: impact at 0
+    CHECK(FindTimeOfImpact(wall, wall, {499.0f, 10.0f, 503.0f, 14.0f}, bulletEnd, timeOfImpact));
+    CHECK(timeOfImpact == 0.0f);
+
+    // through the collision system: a continuous and a discrete bullet start left of thin walls and end past them
+    {
+        CollisionWorld world;
+        Entity bullet = world.AddBox(0.0f, 10.0f, 4, 4, true);
+        Entity firstWall = world.AddBox(500.0f, 0.0f, 2, 100);
+        world.AddBox(700.0f, 0.0f, 2, 100);
+        Entity discreteBullet = world.AddBox(0.0f, 200.0f, 4, 4);
+        world.AddBox(500.0f, 190.0f, 2, 100);
+        CHECK(world.Step().empty());
+
+        bullet.GetComponent<TransformComponent>().position.x = 1000.0f;
+        discreteBullet.GetComponent<TransformComponent>().position.x = 1000.0f;
+        const std::vector<ColliderPair> begins = world.Step();
+
+        // the continuous bullet only hits the first wall, the discrete one goes through unseen
+        CHECK((begins == std::vector<ColliderPair>{{bullet.GetId(), firstWall.GetId()}}));
+
+        // standing still past the walls, the bullet touches nothing new
+        CHECK(world.Step().empty());
+    }
+
+    // two walls reached at the same time are both hit, a later one isn't
+    {
+        CollisionWorld world;
+        Entity bullet = world.AddBox(0.0f, 48.0f, 4, 4, true);
+        Entity upperWall = world.AddBox(500.0f, 0.0f, 2, 50);
+        Entity lowerWall = world.AddBox(500.0f, 50.0f, 2, 50);
+        world.AddBox(800.0f, 0.0f, 2, 100);
+        CHECK(world.Step().empty());
+
+        bullet.GetComponent<TransformComponent>().position.x = 1000.0f;
+        CHECK((world.Step() == std::vector<ColliderPair>{{bullet.GetId(), upperWall.GetId()}, {bullet.GetId(), lowerWall.GetId()}}));
+    }
+
+    // a bullet that stays short of the wall, and one added already past it (it has no last position to sweep from)
+    {
+        CollisionWorld world;
+        Entity bullet = world.AddBox(0.0f, 10.0f, 4, 4, true);
+        world.AddBox(500.0f, 0.0f, 2, 100);
+        CHECK(world.Step().empty());
+
+        bullet.GetComponent<TransformComponent>().position.x = 490.0f;
+        CHECK(world.Step().empty());
+        world.AddBox(600.0f, 10.0f, 4, 4, true);
+        CHECK(world.Step().empty());
+    }
+
+    return TestResult("continuouscollision_test");
+}
@@ -0,0 +1,106 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// eventbus_stress_test.cpp
+// millions of events queued from several threads through EnqueueFrom(): none
+// may be lost, and Flush() must hand them out in the same order whatever the
+// thread count
+// -----------------------------------------------------------------------------
+#include "testing.h"
+#include "eventbus.h"
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+// producers are handed to the threads round-robin, so they finish out of index order
+static constexpr int PRODUCERS = 64;
+static constexpr int EVENTS_PER_PRODUCER = 50000;
+
+// events enqueued directly on the game thread, these come before the producers' ones
+static constexpr int DIRECT_EVENTS = 1000;
+
+// an event carries its producer (a) and its position in that producer's sequence (b),
+// direct events use producer -1
+struct ReceivedEvent {
+    int producer;
+    int sequence;
+};
+
+static std::vector<ReceivedEvent> RunFrame(EventBus& eventBus, unsigned int threadCount) {
+    std::vector<ReceivedEvent> received;
+    received.reserve(DIRECT_EVENTS + static_cast<size_t>(PRODUCERS) * EVENTS_PER_PRODUCER);
+    const EventSubscription subscription = eventBus.SubscribeToEventBatch<CollisionBeginEvent>([&received](std::span<const CollisionBeginEvent> events) {
+        for (const auto& event : events) {
+            received.push_back({event.a.GetId(), event.b.GetId()});
+        }
+    });
+
+    eventBus.ReserveProducers<CollisionBeginEvent>(PRODUCERS);
+    for (int sequence = 0; sequence < DIRECT_EVENTS; sequence++) {
+        eventBus.Enqueue<CollisionBeginEvent>(Entity(-1), Entity(sequence));
+    }
+
+    std::vector<std::thread> threads;
+    for (unsigned int thread = 0; thread < threadCount; thread++) {
+        threads.emplace_back([&eventBus, thread, threadCount] {
+            for (int producer = static_cast<int>(thread); producer < PRODUCERS; producer += threadCount) {
+                for (int sequence = 0; sequence < EVENTS_PER_PRODUCER; sequence++) {
+                    eventBus.EnqueueFrom<CollisionBeginEvent>(producer, Entity(producer), Entity(sequence));
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    eventBus.Flush();
+    eventBus.Unsubscribe(subscription);
+    return received;
+}
+
+// the direct events in order, then producer 0's events in order, then producer 1's, ...
+static size_t CountOutOfOrder(const std::vector<ReceivedEvent>& received) {
+    size_t outOfOrder = 0;
+    size_t index = 0;
+    for (int sequence = 0; sequence < DIRECT_EVENTS && index < received.size(); sequence++, index++) {
+        outOfOrder += received[index].producer != -1 || received[index].sequence != sequence;
+    }
+    for (int producer = 0; producer < PRODUCERS; producer++) {
+        for (int sequence = 0; sequence < EVENTS_PER_PRODUCER && index < received.size(); sequence++, index++) {
+            outOfOrder += received[index].producer != producer || received[index].sequence != sequence;
+        }
+    }
+    return outOfOrder;
+}
+
+int main() {
+    EventBus eventBus;
+    const size_t expectedCount = DIRECT_EVENTS + static_cast<size_t>(PRODUCERS) * EVENTS_PER_PRODUCER;
+
+    // the same frame queued from 1 to 16 threads, twice each (the producer buffers are reused)
+    for (const unsigned int threadCount : {1u, 2u, 4u, 8u, 16u, 1u, 16u}) {
+        const std::vector<ReceivedEvent> received = RunFrame(eventBus, threadCount);
+        CHECK(received.size() == expectedCount);
+        CHECK(CountOutOfOrder(received) == 0);
+        std::printf("%2u threads: %zu events received\n", threadCount, received.size());
+    }
+
+    // nothing is left queued once the frame is flushed
+    size_t leftOver = 0;
+    const EventSubscription subscription = eventBus.SubscribeToEventBatch<CollisionBeginEvent>([&leftOver](std::span<const CollisionBeginEvent> events) {
+        leftOver += events.size();
+    });
+    eventBus.Flush();
+    eventBus.Unsubscribe(subscription);
+    CHECK(leftOver == 0);
+
+    return TestResult("eventbus_stress_test");
+}
@@ -0,0 +1,127 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// narrowphase_test.cpp
+// the batched overlap test (SSE or AVX2, see ECS_SIMD in the Makefile) against
+// AABB::Overlaps pair by pair: every pair count, so the tail past the last full
+// batch is covered, and boxes on a coarse grid, so many edges exactly touch
+// -----------------------------------------------------------------------------
+#include "testing.h"
+#include "narrowphase.h"
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#if defined(__AVX2__)
+static const char* SIMD_PATH = "avx2";
+#elif defined(__SSE2__)
+static const char* SIMD_PATH = "sse2";
+#else
+static const char* SIMD_PATH = "scalar";
+#endif
+
+// boxes with corners on a grid of 8, so neighbours share edges and corners, plus a few
+// points and exact duplicates; returned both as AABBs and as the SoA arrays
+static std::vector<AABB> RandomBounds(std::mt19937& random, int count, ColliderBounds& arrays) {
+    std::uniform_int_distribution<int> cell(-8, 8);
+    std::uniform_int_distribution<int> size(0, 3);
+    std::vector<AABB> bounds;
+    for (int i = 0; i < count; i++) {
+        if (i > 0 && random() % 10 == 0) {
+            bounds.push_back(bounds[random() % bounds.size()]);
+            continue;
+        }
+        const float x = cell(random) * 8.0f;
+        const float y = cell(random) * 8.0f;
+        bounds.push_back({x, y, x + size(random) * 8.0f, y + size(random) * 8.0f});
+    }
+    arrays.Resize(bounds.size());
+    for (size_t i = 0; i < bounds.size(); i++) {
+        arrays.Set(i, bounds[i]);
+    }
+    return bounds;
+}
+
+static std::vector<ColliderPair> Reference(const std::vector<AABB>& bounds, const std::vector<ColliderPair>& pairs) {
+    std::vector<ColliderPair> overlapping;
+    for (const auto& pair : pairs) {
+        if (bounds[pair.a].Overlaps(bounds[pair.b])) {
+            overlapping.push_back(pair);
+        }
+    }
+    return overlapping;
+}
+
+int main() {
+    std::mt19937 random(2024);
+
+    // every pair count up to a few batches, then some big ones
+    std::vector<int> pairCounts;
+    for (int count = 0; count <= 40; count++) {
+        pairCounts.push_back(count);
+    }
+    for (const int count : {255, 256, 257, 1023, 4099}) {
+        pairCounts.push_back(count);
+    }
+
+    size_t comparedPairs = 0;
+    size_t touchingPairs = 0;
+    for (const int pairCount : pairCounts) {
+        for (int repetition = 0; repetition < 20; repetition++) {
+            ColliderBounds arrays;
+            const std::vector<AABB> bounds = RandomBounds(random, 64, arrays);
+            std::vector<ColliderPair> pairs;
+            for (int i = 0; i < pairCount; i++) {
+                const int a = static_cast<int>(random() % bounds.size());
+                const int b = static_cast<int>(random() % bounds.size());
+                pairs.push_back({std::min(a, b), std::max(a, b)});
+
+                // touching: the boxes meet on an edge or a corner without overlapping
+                const AABB& boxA = bounds[a];
+                const AABB& boxB = bounds[b];
+                touchingPairs += !boxA.Overlaps(boxB) && boxA.minX <= boxB.maxX && boxA.maxX >= boxB.minX && boxA.minY <= boxB.maxY && boxA.maxY >= boxB.minY;
+            }
+
+            // the output buffer starts filled with a marker, only the returned count may be read
+            std::vector<ColliderPair> overlaps(pairs.size(), ColliderPair{-1, -1});
+            const size_t count = FindOverlappingPairs(arrays, pairs, overlaps.data());
+            overlaps.resize(count);
+            CHECK(overlaps == Reference(bounds, pairs));
+            comparedPairs += pairs.size();
+        }
+    }
+    CHECK(touchingPairs > 0);
+    std::printf("%s path: %zu pairs compared, %zu of them touching\n", SIMD_PATH, comparedPairs, touchingPairs);
+
+    // touching on each side, overlapping by the smallest float step, and the box with itself
+    ColliderBounds arrays;
+    const std::vector<AABB> bounds = {
+        {0.0f, 0.0f, 10.0f, 10.0f},
+        {10.0f, 0.0f, 20.0f, 10.0f},            // right of 0
+        {-10.0f, 0.0f, 0.0f, 10.0f},            // left of 0
+        {0.0f, 10.0f, 10.0f, 20.0f},            // below 0
+        {0.0f, -10.0f, 10.0f, 0.0f},            // above 0
+        {10.0f, 10.0f, 20.0f, 20.0f},           // corner of 0
+        {std::nextafter(10.0f, 0.0f), 0.0f, 20.0f, 10.0f},
+        {5.0f, 5.0f, 5.0f, 5.0f}                // a point inside 0
+    };
+    arrays.Resize(bounds.size());
+    for (size_t i = 0; i < bounds.size(); i++) {
+        arrays.Set(i, bounds[i]);
+    }
+    const std::vector<ColliderPair> pairs = {{0, 1}, {0, 2}, {0, 3}, {0, 4}, {0, 5}, {0, 6}, {0, 7}, {0, 0}, {1, 6}};
+    std::vector<ColliderPair> overlaps(pairs.size());
+    overlaps.resize(FindOverlappingPairs(arrays, pairs, overlaps.data()));
+    CHECK(overlaps == Reference(bounds, pairs));
+    CHECK((overlaps == std::vector<ColliderPair>{{0, 6}, {0, 7}, {0, 0}, {1, 6}}));
+
+    return TestResult("narrowphase_test");
+}
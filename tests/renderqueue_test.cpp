@@ -0,0 +1,118 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// renderqueue_test.cpp
+// the render queue's draw order: the key layout (z-index, then texture, then
+// queue order), and sprites added, removed and changed every frame, after
+// which the queue must equal a full sort of every sprite by its key
+// -----------------------------------------------------------------------------
+#include "testing.h"
+#include "renderqueue.h"
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <random>
+#include <vector>
+
+// the textures the sprites use, and one the asset store doesn't have
+static const char* ASSET_IDS[] = {"tank-image", "truck-image", "tree-image", "bullet-image", "missing-image"};
+static const char* ASSET_FILES[] = {"./assets/images/tank-panther-right.png", "./assets/images/truck-ford-right.png", "./assets/images/tree.png", "./assets/images/bullet.png"};
+
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    // the key layout: z-index first, then the texture (no texture last), then the sequence
+    CHECK(RenderQueue::MakeKey(-1, 0xFFFE, 0xFFFFFFFF) < RenderQueue::MakeKey(0, 0, 0));
+    CHECK(RenderQueue::MakeKey(0, 0, 0xFFFFFFFF) < RenderQueue::MakeKey(0, 1, 0));
+    CHECK(RenderQueue::MakeKey(0, 0xFFFE, 0xFFFFFFFF) < RenderQueue::MakeKey(0, -1, 0));
+    CHECK(RenderQueue::MakeKey(0, 3, 7) < RenderQueue::MakeKey(0, 3, 8));
+    CHECK(RenderQueue::MakeKey(0, 3, 7) == ((uint64_t(0x8000) << 48) | (uint64_t(3) << 32) | 7));
+    // z-indexes past 16 bits are clamped, they still sort first/last
+    CHECK(RenderQueue::MakeKey(-100000, 0, 0) <= RenderQueue::MakeKey(-0x8000, 0, 0));
+    CHECK(RenderQueue::MakeKey(100000, 0, 0) >= RenderQueue::MakeKey(0x7FFF, 0, 0));
+
+    // the texture handles come from the asset store (without a renderer the textures stay empty,
+    // but every asset id still gets its handle)
+    AssetStore assetStore;
+    for (size_t i = 0; i < std::size(ASSET_FILES); i++) {
+        assetStore.AddTexture(nullptr, ASSET_IDS[i], ASSET_FILES[i]);
+    }
+
+    // sprites churned every frame: some added, some killed (their ids reused), some moved to
+    // another z-index or texture
+    Registry registry;
+    RenderQueue renderQueue;
+    std::mt19937 random(2024);
+    std::uniform_int_distribution<int> zIndex(-3, 3);
+    std::uniform_int_distribution<int> asset(0, std::size(ASSET_IDS) - 1);
+    std::vector<Entity> sprites;
+
+    // the queue order the sprites were first seen in, per entity (a changed sprite keeps its place)
+    std::map<Entity, uint32_t> sequences;
+    uint32_t nextSequence = 0;
+
+    size_t mismatches = 0;
+    size_t textureSwitchMismatches = 0;
+    for (int frame = 0; frame < 500; frame++) {
+        const int added = frame == 0 ? 2000 : static_cast<int>(random() % 40);
+        for (int i = 0; i < added; i++) {
+            Entity entity = registry.CreateEntity();
+            entity.AddComponent<SpriteComponent>(ASSET_IDS[asset(random)], 32, 32, zIndex(random));
+            sprites.push_back(entity);
+        }
+        for (int i = static_cast<int>(random() % 40); i > 0 && !sprites.empty(); i--) {
+            const size_t index = random() % sprites.size();
+            sprites[index].Kill();
+            sequences.erase(sprites[index]);
+            sprites.erase(sprites.begin() + index);
+        }
+        for (int i = static_cast<int>(random() % 60); i > 0 && !sprites.empty(); i--) {
+            auto& sprite = sprites[random() % sprites.size()].GetComponent<SpriteComponent>();
+            if (random() % 2) {
+                sprite.zIndex = zIndex(random);
+            } else {
+                sprite.assetId = ASSET_IDS[asset(random)];
+            }
+        }
+        registry.Update();
+
+        // every 50 frames the sprites come in another order, the queue order must not depend on it
+        if (frame % 50 == 49) {
+            std::shuffle(sprites.begin(), sprites.end(), random);
+        }
+        renderQueue.Update(sprites, assetStore);
+
+        // the reference: every sprite keyed from scratch, fully sorted
+        std::vector<std::pair<uint64_t, Entity>> expected;
+        for (const auto& entity : sprites) {
+            const auto [sequence, isNew] = sequences.try_emplace(entity, nextSequence);
+            nextSequence += isNew;
+            const auto& sprite = entity.GetComponent<SpriteComponent>();
+            expected.push_back({RenderQueue::MakeKey(sprite.zIndex, assetStore.GetTextureHandle(sprite.assetId), sequence->second), entity});
+        }
+        std::sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+        const auto& items = renderQueue.GetItems();
+        bool same = items.size() == expected.size();
+        size_t textureSwitches = 0;
+        for (size_t i = 0; same && i < items.size(); i++) {
+            same = items[i].key == expected[i].first && items[i].entity == expected[i].second &&
+                renderQueue.GetItemIndex(items[i].entity.GetId()) == static_cast<int>(i);
+            textureSwitches += i == 0 || items[i].textureHandle != items[i - 1].textureHandle;
+        }
+        mismatches += !same;
+        textureSwitchMismatches += same && renderQueue.GetTextureSwitches() != textureSwitches;
+    }
+    CHECK(mismatches == 0);
+    CHECK(textureSwitchMismatches == 0);
+    std::printf("500 frames, %zu sprites on the last one: %zu mismatched frames\n", sprites.size(), mismatches);
+
+    return TestResult("renderqueue_test");
+}
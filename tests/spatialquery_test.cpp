@@ -0,0 +1,216 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// spatialquery_test.cpp
+// the collision system's spatial queries (area, point, radius, raycast) with
+// every broadphase backend, against brute force over all the colliders, plus
+// the raycast hit order and an empty world
+// -----------------------------------------------------------------------------
+#include "testing.h"
+#include "collisionworld.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+static constexpr BroadphaseType BACKENDS[] = {
+    BroadphaseType::BruteForce,
+    BroadphaseType::SpatialHash,
+    BroadphaseType::DynamicTree,
+    BroadphaseType::SweepAndPrune
+};
+
+// the layers the random colliders are spread over
+static constexpr CollisionLayer LAYERS[] = {CollisionLayer::Default, CollisionLayer::Player, CollisionLayer::Enemy, CollisionLayer::Static};
+
+struct Collider {
+    Entity entity;
+    AABB bounds;
+    uint32_t layerBit;
+};
+
+// where every collider is now, the way the collision system computes it
+static std::vector<Collider> GetColliders(const std::vector<Entity>& entities) {
+    std::vector<Collider> colliders;
+    for (const auto& entity : entities) {
+        const auto& collider = entity.GetComponent<BoxColliderComponent>();
+        colliders.push_back({entity, AABB::FromCollider(entity.GetComponent<TransformComponent>(), collider), LayerMask(collider.layer)});
+    }
+    return colliders;
+}
+
+static std::vector<Entity> Sorted(std::vector<Entity> entities) {
+    std::sort(entities.begin(), entities.end());
+    return entities;
+}
+
+static bool SameHits(const std::vector<RaycastHit>& hits, const std::vector<RaycastHit>& expected) {
+    if (hits.size() != expected.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < hits.size(); i++) {
+        if (hits[i].entity != expected[i].entity || hits[i].fraction != expected[i].fraction || hits[i].point != expected[i].point) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the queries on a world of random colliders, a few of them continuous and moved between the frames
+// (the broadphase holds their swept bounds, the queries must only see where they ended)
+static size_t CountMismatches(BroadphaseType type, std::mt19937& random) {
+    std::uniform_real_distribution<float> position(-200.0f, 1200.0f);
+    std::uniform_int_distribution<int> size(1, 80);
+    std::uniform_int_distribution<int> layer(0, std::size(LAYERS) - 1);
+
+    CollisionWorld world;
+    BroadphaseSettings settings;
+    settings.type = type;
+    world.GetCollisionSystem().SetBroadphase(settings);
+
+    std::vector<Entity> entities;
+    for (int i = 0; i < 600; i++) {
+        entities.push_back(world.AddBox(position(random), position(random), size(random), size(random), i % 10 == 0, LAYERS[layer(random)]));
+    }
+    world.Step();
+    for (size_t i = 0; i < entities.size(); i += 5) {
+        entities[i].GetComponent<TransformComponent>().position = glm::vec2(position(random), position(random));
+    }
+    world.Step();
+
+    const CollisionSystem& collisionSystem = world.GetCollisionSystem();
+    const std::vector<Collider> colliders = GetColliders(entities);
+    std::vector<Entity> results;
+    std::vector<RaycastHit> hits;
+    size_t mismatches = 0;
+    for (int query = 0; query < 300; query++) {
+        const uint32_t layerMask = query % 3 == 0 ? ALL_LAYERS : LayerMask(LAYERS[layer(random)], LAYERS[layer(random)]);
+        const glm::vec2 point(position(random), position(random));
+        std::vector<Entity> expected;
+
+        // area
+        const AABB area = {point.x, point.y, point.x + size(random) * 3, point.y + size(random) * 3};
+        collisionSystem.QueryAABB(area, results, layerMask);
+        expected.clear();
+        for (const auto& collider : colliders) {
+            if ((collider.layerBit & layerMask) && collider.bounds.Overlaps(area)) {
+                expected.push_back(collider.entity);
+            }
+        }
+        mismatches += Sorted(results) != Sorted(expected);
+
+        // point
+        collisionSystem.QueryPoint(point, results, layerMask);
+        expected.clear();
+        for (const auto& collider : colliders) {
+            const AABB& bounds = collider.bounds;
+            if ((collider.layerBit & layerMask) && point.x > bounds.minX && point.x < bounds.maxX && point.y > bounds.minY && point.y < bounds.maxY) {
+                expected.push_back(collider.entity);
+            }
+        }
+        mismatches += Sorted(results) != Sorted(expected);
+
+        // radius
+        const float radius = static_cast<float>(size(random));
+        collisionSystem.QueryRadius(point, radius, results, layerMask);
+        expected.clear();
+        for (const auto& collider : colliders) {
+            const AABB& bounds = collider.bounds;
+            const float dx = point.x - std::clamp(point.x, bounds.minX, bounds.maxX);
+            const float dy = point.y - std::clamp(point.y, bounds.minY, bounds.maxY);
+            if ((collider.layerBit & layerMask) && dx * dx + dy * dy < radius * radius) {
+                expected.push_back(collider.entity);
+            }
+        }
+        mismatches += Sorted(results) != Sorted(expected);
+
+        // raycast, nearest hit first
+        const glm::vec2 end(position(random), position(random));
+        collisionSystem.Raycast(point, end, hits, layerMask);
+        const AABB start = {point.x, point.y, point.x, point.y};
+        const AABB finish = {end.x, end.y, end.x, end.y};
+        std::vector<RaycastHit> expectedHits;
+        for (const auto& collider : colliders) {
+            float fraction;
+            if ((collider.layerBit & layerMask) && FindTimeOfImpact(start, finish, collider.bounds, collider.bounds, fraction)) {
+                expectedHits.push_back({collider.entity, fraction, point + (end - point) * fraction});
+            }
+        }
+        std::sort(expectedHits.begin(), expectedHits.end(), [](const RaycastHit& a, const RaycastHit& b) {
+            return a.fraction < b.fraction || (a.fraction == b.fraction && a.entity < b.entity);
+        });
+        mismatches += !SameHits(hits, expectedHits);
+    }
+    return mismatches;
+}
+
+int main() {
+    spdlog::set_level(spdlog::level::warn);
+
+    std::mt19937 random(2024);
+    for (const auto type : BACKENDS) {
+        const size_t mismatches = CountMismatches(type, random);
+        CHECK(mismatches == 0);
+        std::printf("%s: %zu mismatched queries\n", CreateBroadphase({type})->GetName(), mismatches);
+    }
+
+    // a ray along a row of boxes hits them nearest first, from either end
+    {
+        CollisionWorld world;
+        Entity first = world.AddBox(100.0f, 0.0f, 10, 10);
+        Entity second = world.AddBox(200.0f, 0.0f, 10, 10);
+        Entity third = world.AddBox(300.0f, 0.0f, 10, 10, false, CollisionLayer::Enemy);
+        world.AddBox(200.0f, 100.0f, 10, 10);
+        world.Step();
+
+        std::vector<RaycastHit> hits;
+        world.GetCollisionSystem().Raycast(glm::vec2(0.0f, 5.0f), glm::vec2(400.0f, 5.0f), hits);
+        CHECK(hits.size() == 3);
+        CHECK(hits.size() == 3 && hits[0].entity == first && hits[1].entity == second && hits[2].entity == third);
+        CHECK(hits.size() == 3 && hits[0].fraction == 0.25f && hits[1].fraction == 0.5f && hits[2].fraction == 0.75f);
+        CHECK(hits.size() == 3 && hits[0].point == glm::vec2(100.0f, 5.0f));
+
+        world.GetCollisionSystem().Raycast(glm::vec2(400.0f, 5.0f), glm::vec2(0.0f, 5.0f), hits);
+        CHECK(hits.size() == 3 && hits[0].entity == third && hits[1].entity == second && hits[2].entity == first);
+
+        // from inside a box (hit at 0), limited to a layer, and a ray passing beside the boxes
+        world.GetCollisionSystem().Raycast(glm::vec2(205.0f, 5.0f), glm::vec2(400.0f, 5.0f), hits);
+        CHECK(hits.size() == 2 && hits[0].entity == second && hits[0].fraction == 0.0f);
+        world.GetCollisionSystem().Raycast(glm::vec2(0.0f, 5.0f), glm::vec2(400.0f, 5.0f), hits, LayerMask(CollisionLayer::Enemy));
+        CHECK(hits.size() == 1 && hits[0].entity == third);
+        world.GetCollisionSystem().Raycast(glm::vec2(0.0f, 50.0f), glm::vec2(400.0f, 50.0f), hits);
+        CHECK(hits.empty());
+    }
+
+    // an empty world answers nothing, before and after its first update
+    for (const auto type : BACKENDS) {
+        CollisionWorld world;
+        BroadphaseSettings settings;
+        settings.type = type;
+        world.GetCollisionSystem().SetBroadphase(settings);
+        for (int frame = 0; frame < 2; frame++) {
+            std::vector<Entity> results = {Entity(7)};
+            std::vector<RaycastHit> hits = {{Entity(7), 0.0f, glm::vec2(0.0f)}};
+            world.GetCollisionSystem().QueryAABB({-1000.0f, -1000.0f, 1000.0f, 1000.0f}, results);
+            CHECK(results.empty());
+            results.push_back(Entity(7));
+            world.GetCollisionSystem().QueryPoint(glm::vec2(0.0f), results);
+            CHECK(results.empty());
+            results.push_back(Entity(7));
+            world.GetCollisionSystem().QueryRadius(glm::vec2(0.0f), 1000.0f, results);
+            CHECK(results.empty());
+            world.GetCollisionSystem().Raycast(glm::vec2(-1000.0f), glm::vec2(1000.0f), hits);
+            CHECK(hits.empty());
+            world.Step();
+        }
+    }
+
+    return TestResult("spatialquery_test");
+}
@@ -0,0 +1,43 @@
+/*
+ * author: Dylan Campbell
+ * contact: campbell.dyl@gmail.com
+ * project: 2d game engine
+ *
+ * This program contains source code from Gustavo Pezzi's "C++ 2D Game Engine
+ * Development" course, found here: https://pikuma.com/courses
+*/
+
+// -----------------------------------------------------------------------------
+// testing.h
+// the checks shared by the test programs (make test): CHECK(condition) reports
+// a failed condition and carries on, main returns TestResult(name)
+// -----------------------------------------------------------------------------
+#ifndef TESTING_H
+#define TESTING_H
+
+#include <cstdio>
+
+inline int& TestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            TestFailures()++; \
+        } \
+    } while (0)
+
+// prints the outcome of a test program, and returns its exit code
+inline int TestResult(const char* name) {
+    if (TestFailures() > 0) {
+        std::printf("%s: %d check(s) failed\n", name, TestFailures());
+        return 1;
+    }
+    std::printf("%s: passed\n", name);
+    return 0;
+}
+
+#endif